@@ -0,0 +1,57 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "camerapath.h"
+
+// Flies the camera along a path once per render mode and measures every frame,
+// to compare performance across builds. Runs headless, see Window.
+class Benchmark
+{
+public:
+    // Fixed time step of the path and of animations, so that every run renders the same frames
+    static constexpr float FRAME_TIME = 1.f / 60.f;
+
+    // Frames rendered (but not measured) before each render mode, once all programs are ready
+    static const uint WARMUP_FRAMES = 30;
+
+    // Read the camera path, check last argument for errors
+    Benchmark(const std::string &path_filepath, const std::vector<std::string> &render_mode_names, bool &success);
+
+    // Start a frame: get the camera pose and render mode to draw with.
+    // Frames are measured only once programs_ready is true (see ProgramWarmup) and the warmup frames are done.
+    // Returns false once the path was flown in every render mode.
+    bool begin_frame(bool programs_ready, glm::vec3 &position, float &yaw, float &pitch, uint &render_mode);
+
+    // Finish a frame, waiting for the GPU so that the time includes rendering, and record frame_stats
+    void end_frame();
+
+    // Write frame time percentiles and per-frame counters of each render mode as JSON
+    bool write_report(const std::string &filepath) const;
+
+private:
+    std::string path_filepath;
+    CameraPath path;
+    std::vector<std::string> render_mode_names;
+
+    // Progress
+    uint mode;
+    uint frame; // measured frames of the current mode
+    uint warmup_frames_left;
+    bool measuring; // whether the current frame counts
+    std::chrono::steady_clock::time_point frame_start;
+
+    struct ModeResults
+    {
+        std::vector<float> frame_ms;
+        uint64_t draw_calls = 0;
+        uint64_t models_visible = 0;
+        uint64_t gl_calls_issued = 0;
+    };
+    std::vector<ModeResults> results;
+};
+
+#endif // BENCHMARK_H_
@@ -0,0 +1,21 @@
+#ifndef BOUNDS_H_
+#define BOUNDS_H_
+
+#include <glm/glm.hpp>
+
+// Bounding volumes of a piece of geometry, in its own (model) space
+struct Bounds
+{
+    glm::vec3 min; // corners of the axis aligned bounding box
+    glm::vec3 max;
+    glm::vec3 center; // bounding sphere around the box center
+    float radius;
+};
+
+// Smallest bounds around both arguments (the sphere is kept around the merged box center)
+Bounds merge_bounds(const Bounds &a, const Bounds &b);
+
+// Bounding sphere of transformed bounds, with the radius scaled by the largest axis scale
+void transform_sphere(const Bounds &bounds, const glm::mat4 &transform, glm::vec3 &center, float &radius);
+
+#endif // BOUNDS_H_
@@ -0,0 +1,117 @@
+#ifndef BVH_H_
+#define BVH_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// Bounding volume hierarchies for ray casting on the CPU.
+// Nothing here touches OpenGL, so picking works without a framebuffer.
+
+// Axis aligned box
+struct Box
+{
+    glm::vec3 min;
+    glm::vec3 max;
+
+    // An empty box, which grows to fit anything added
+    static Box empty();
+    void grow(const glm::vec3 &point);
+    void grow(const Box &box);
+    glm::vec3 center() const;
+
+    // Box around this box after transformation
+    Box transformed(const glm::mat4 &transform) const;
+
+    // Distance along the ray where it enters the box, if it does before max_distance
+    bool intersect(const glm::vec3 &origin, const glm::vec3 &inverse_direction, float max_distance, float &distance) const;
+};
+
+// Half-line from origin along direction (not necessarily normalized, distances are in units of it)
+struct Ray
+{
+    glm::vec3 origin;
+    glm::vec3 direction;
+};
+
+// Node of a binary hierarchy, leaves refer to a range of primitives
+struct BVHNode
+{
+    Box box;
+    uint first; // first primitive for leaves, first child (second is first + 1) for inner nodes
+    uint count; // number of primitives for leaves, 0 for inner nodes
+};
+
+// Hierarchy over the triangles of one model, in model space
+class TriangleBVH
+{
+public:
+    // Build from three vertex positions per triangle
+    TriangleBVH(const std::vector<glm::vec3> &triangle_vertices);
+
+    // Nearest triangle hit by the ray before max_distance, returns false if none
+    bool intersect(const Ray &ray, float max_distance, uint &triangle, float &distance) const;
+
+    // Bounds of all triangles
+    Box bounds() const;
+
+    size_t num_triangles() const;
+
+private:
+    std::vector<BVHNode> nodes;
+    std::vector<glm::vec3> vertices; // three per triangle, reordered so that leaves are contiguous
+    std::vector<uint> triangle_ids; // original index of every reordered triangle
+};
+
+// Hierarchy over the world bounds of many objects.
+// The structure is built once, and refitted as objects move.
+class SceneBVH
+{
+public:
+    // Build over object boxes, object i has boxes[i]
+    void build(const std::vector<Box> &boxes);
+
+    // Update boxes of the same objects without changing the structure
+    void refit(const std::vector<Box> &boxes);
+
+    // Visit objects whose boxes the ray hits before the current max_distance.
+    // hit_object(index, max_distance) tests object index and lowers max_distance on a nearer hit.
+    template <typename F>
+    void intersect(const Ray &ray, float &max_distance, F &&hit_object) const;
+
+private:
+    std::vector<BVHNode> nodes;
+    std::vector<uint> objects; // object indices, reordered so that leaves are contiguous
+};
+
+// Depth of the traversal stack, enough for any hierarchy built here
+const uint BVH_STACK_SIZE = 64;
+
+template <typename F>
+void SceneBVH::intersect(const Ray &ray, float &max_distance, F &&hit_object) const
+{
+    if (nodes.empty()) return;
+    glm::vec3 inverse_direction = 1.f / ray.direction;
+    uint stack[BVH_STACK_SIZE];
+    uint stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        const BVHNode &node = nodes[stack[--stack_size]];
+        float entry;
+        if (!node.box.intersect(ray.origin, inverse_direction, max_distance, entry)) continue;
+        if (node.count > 0)
+        {
+            for (uint i = node.first; i < node.first + node.count; i++)
+            {
+                hit_object(objects[i], max_distance);
+            }
+        }
+        else
+        {
+            stack[stack_size++] = node.first;
+            stack[stack_size++] = node.first + 1;
+        }
+    }
+}
+
+#endif // BVH_H_
@@ -2,6 +2,7 @@
 #define CAMERA_H_
 
 #include <glm/glm.hpp>
+#include "bvh.h"
 
 class Camera
 {
@@ -14,6 +15,9 @@ public:
     glm::mat4 get_view() const;
     glm::mat4 get_projection() const;
 
+    // Ray in world space from the camera through a point on screen, given in normalized device coordinates
+    Ray ray_through(float ndc_x, float ndc_y) const;
+
     glm::vec3 position;
 
 private:
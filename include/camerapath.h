@@ -0,0 +1,34 @@
+#ifndef CAMERAPATH_H_
+#define CAMERAPATH_H_
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// A camera flight read from a text file, one keyframe per line:
+//   time x y z yaw pitch
+// with time in seconds (increasing), position in world space and angles in radians, as in Camera.
+// Empty lines and lines starting with # are ignored. Poses in between keyframes are interpolated linearly.
+class CameraPath
+{
+public:
+    // Read keyframes, check last argument for errors
+    CameraPath(const std::string &filepath, bool &success);
+
+    // Pose at a time, clamped to the first and last keyframes
+    void sample(float time, glm::vec3 &position, float &yaw, float &pitch) const;
+
+    // Time of the last keyframe
+    float duration() const;
+
+private:
+    struct Keyframe
+    {
+        float time;
+        glm::vec3 position;
+        float yaw, pitch;
+    };
+    std::vector<Keyframe> keyframes;
+};
+
+#endif // CAMERAPATH_H_
@@ -1,7 +1,10 @@
 #ifndef CUBEMAP_H_ 
 #define CUBEMAP_H_
 
+#include <memory>
 #include <string>
+#include <vector>
+#include "image.h"
 
 
 // A specialized texture that can be sampled in all directions in 3D
@@ -11,6 +14,9 @@ public:
     // Load cubemap from a set of image files in the following order: 
     // right, left, top, bottom, front, back
     CubeMap(std::string texture_directory);
+
+    // Copy six already decoded faces, in the same order as above, into a new cubemap
+    CubeMap(const std::vector<std::unique_ptr<Image>> &faces);
     
     // Do not allow implicit copy due to OpenGL resource management
     CubeMap(const CubeMap&) = delete;
@@ -22,8 +28,14 @@ public:
     // Activate texture unit
     void activate(uint unit) const;
 
+    // Paths of the six face images inside a cubemap directory, in loading order
+    static std::vector<std::string> face_paths(const std::string &texture_directory);
+
     // OpenGL index of texture
     uint id;
+
+    // Approximate size on GPU of all faces, in bytes
+    size_t gpu_bytes;
 };
 
 
@@ -2,14 +2,16 @@
 #define FLASHLIGHT_H_
 
 #include <glm/glm.hpp>
-#include "shaders.h"
+#include "frameuniforms.h"
 
 class Flashlight
 {
 public:
     // Construct flashlight
     Flashlight(float min_pitch, float max_pitch, float min_yaw, float max_yaw);
-    void use(const Shaders &program, const glm::mat4 &view) const;
+
+    // Write light parameters into the per-frame uniform data
+    void use(LightData &data, const glm::mat4 &view) const;
 
 private:
     float min_pitch, max_pitch;
@@ -0,0 +1,98 @@
+#ifndef FRAMESTATS_H_
+#define FRAMESTATS_H_
+
+#include <cstdint>
+
+// Calls into the OpenGL entry points the renderer uses, counted as they happen (see glcounters.h)
+struct GLCalls
+{
+    uint draw_calls; // glDraw*, instanced ones counting once
+    uint64_t indices; // indices, or vertices of non-indexed draws, times instances
+    uint program_binds; // glUseProgram
+    uint texture_binds; // glBindTexture
+    uint uniform_uploads; // glUniform*
+    uint buffer_uploads; // glBufferData and glBufferSubData
+    uint64_t buffer_upload_bytes;
+    uint framebuffer_binds; // glBindFramebuffer
+};
+
+// Counters of the frame being rendered.
+// Averaged over one second and printed when statistics are enabled (key 6).
+struct FrameStats
+{
+    uint64_t allocations; // heap allocations
+    GLCalls gl; // calls into OpenGL
+    uint uniform_location_queries; // uniform locations looked up by name through the driver
+    uint models_visible; // placements inside the view frustum
+    uint models_culled; // placements skipped entirely
+    uint meshes_culled; // meshes of visible placements skipped
+    uint program_binds_avoided; // state changes saved by sorting the render queue
+    uint texture_binds_avoided;
+    uint vertex_array_binds_avoided;
+    uint gl_calls_issued; // state changes that reached the driver (see glstate.h)
+    uint gl_calls_elided; // state changes dropped because they would change nothing
+};
+
+// Counters of the current frame
+extern FrameStats frame_stats;
+
+// Most passes told apart in one frame, calls of later ones count towards the frame only
+#define MAX_STATS_PASSES 16
+
+// Calls into OpenGL and CPU time during one pass of a frame
+struct PassStats
+{
+    const char *name;
+    GLCalls gl;
+    float cpu_ms;
+};
+
+// Counts the calls into OpenGL and the CPU time during its lifetime as a pass of the current frame.
+// Passes of the same name add up. The name must be a string literal, only its pointer is kept.
+class StatsPass
+{
+public:
+    StatsPass(const char *name);
+    ~StatsPass();
+
+    // Do not allow copy, a pass ends once
+    StatsPass(const StatsPass&) = delete;
+    StatsPass& operator=(const StatsPass&) = delete;
+
+private:
+    const char *name;
+    GLCalls start;
+    uint64_t start_ns;
+};
+
+// Passes of the current frame so far, in the order they first ended
+const PassStats *frame_passes(uint &num_passes);
+
+// What allocates GPU memory, tracked live
+enum GpuMemoryKind
+{
+    GPU_MEMORY_MESHES, // vertex, index and instance buffers of models
+    GPU_MEMORY_TEXTURES,
+    GPU_MEMORY_CUBE_MAPS,
+    GPU_MEMORY_SKYBOX,
+    GPU_MEMORY_GROUND,
+    GPU_MEMORY_SELECTION, // object ID and off-screen scene buffers
+    NUM_GPU_MEMORY_KINDS
+};
+
+// Add memory allocated on the GPU, or remove it with a negative amount, from constructors and destructors of its owner
+void track_gpu_memory(GpuMemoryKind kind, int64_t bytes);
+
+// Bytes currently allocated on the GPU of one kind
+int64_t gpu_memory(GpuMemoryKind kind);
+
+// Number of heap allocations since startup, counted by the global operator new
+uint64_t allocation_count();
+
+// Reset counters for a new frame
+void begin_frame_stats();
+
+// Accumulate counters of the finished frame and print averages once per second if enabled
+void end_frame_stats(float delta_time);
+
+#endif // FRAMESTATS_H_
@@ -0,0 +1,61 @@
+#ifndef FRAMEUNIFORMS_H_
+#define FRAMEUNIFORMS_H_
+
+#include <glm/glm.hpp>
+
+// Uniform buffer binding point of the FrameData block, shared by all shader programs
+#define FRAME_DATA_BINDING 0
+
+// Mirrors struct LightSource in shaders/include/frame_data.glsl, laid out by std140 rules
+struct LightData
+{
+    glm::vec4 color; // rgb
+    glm::vec4 position; // xyz, in world space
+    glm::vec4 direction; // xyz, in world space
+    float is_on;
+    float diffuse_intensity;
+    float specular_intensity;
+    float strength; // used for calculating attenuation
+};
+
+// Mirrors the FrameData uniform block in shaders/include/frame_data.glsl, laid out by std140 rules
+struct FrameData
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 vp; // projection * view
+    glm::vec4 camera_position; // xyz, in world space
+    LightData light; // point light
+    LightData sun;
+    LightData flashlight;
+    float ambient_light_intensity;
+    uint hovered_object_id; // 0 if none
+    float padding[2];
+};
+
+// Per-frame camera and lighting data, uploaded once per frame into a uniform buffer
+// that every shader program reads through the FrameData block
+class FrameUniforms
+{
+public:
+    // Create the uniform buffer and attach it to FRAME_DATA_BINDING
+    FrameUniforms();
+
+    // Do not allow implicit copy due to OpenGL resource management
+    FrameUniforms(const FrameUniforms&) = delete;
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+    // Free resources
+    ~FrameUniforms();
+
+    // Copy data to the GPU, call once per frame after filling it
+    void upload() const;
+
+    // Contents of the next upload
+    FrameData data;
+
+private:
+    uint ubo; // Index of uniform buffer on GPU
+};
+
+#endif // FRAMEUNIFORMS_H_
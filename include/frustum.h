@@ -0,0 +1,37 @@
+#ifndef FRUSTUM_H_
+#define FRUSTUM_H_
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Bounding spheres in world space, stored as separate arrays so that they can be tested four at a time
+struct PackedSpheres
+{
+    std::vector<float> x, y, z, radius;
+
+    // Forget all spheres, keeping storage
+    void clear();
+    void add(glm::vec3 center, float radius);
+    size_t size() const;
+};
+
+// The six planes of the camera's view volume, used to skip geometry that cannot be on screen
+class Frustum
+{
+public:
+    // Extract planes from a projection * view matrix
+    void update(const glm::mat4 &vp);
+
+    // Whether a sphere is at least partially inside
+    bool intersects(glm::vec3 center, float radius) const;
+
+    // Test all spheres, visible[i] is set to 1 if sphere i is at least partially inside, to 0 otherwise
+    void cull(const PackedSpheres &spheres, std::vector<uint8_t> &visible) const;
+
+private:
+    // Plane i is dot(planes[i].xyz, p) + planes[i].w = 0, normals point into the frustum
+    glm::vec4 planes[6];
+};
+
+#endif // FRUSTUM_H_
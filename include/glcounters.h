@@ -0,0 +1,9 @@
+#ifndef GLCOUNTERS_H_
+#define GLCOUNTERS_H_
+
+// Replace glad's pointers to the OpenGL entry points the renderer uses with wrappers
+// that count each call into frame_stats.gl (see framestats.h) and forward it.
+// Call once, right after loading OpenGL.
+void install_gl_counters();
+
+#endif // GLCOUNTERS_H_
@@ -0,0 +1,40 @@
+#ifndef GLSTATE_H_
+#define GLSTATE_H_
+
+#include <sys/types.h>
+
+// Shadow copy of the OpenGL binding and pipeline state that the renderer changes.
+// Each function below calls into the driver only if the value differs from the last one set,
+// otherwise the call is elided. Counts of both go to frame_stats.
+// All changes of this state must go through here, or the shadow copy goes stale.
+// Values start out unknown, so the first call always reaches the driver.
+
+// glUseProgram
+void state_use_program(uint program);
+
+// glBindVertexArray
+void state_bind_vertex_array(uint vertex_array);
+
+// glActiveTexture and glBindTexture, tracked per texture unit and target
+void state_bind_texture(uint unit, uint target, uint texture);
+
+// glStencilFunc, glStencilOp and glStencilMask
+void state_stencil_func(uint func, int ref, uint mask);
+void state_stencil_op(uint stencil_fail, uint depth_fail, uint depth_pass);
+void state_stencil_mask(uint mask);
+
+// glDepthFunc
+void state_depth_func(uint func);
+
+// glPolygonMode for GL_FRONT_AND_BACK
+void state_polygon_mode(uint mode);
+
+// glEnable or glDisable, for GL_DEPTH_TEST, GL_STENCIL_TEST, GL_CULL_FACE and GL_SCISSOR_TEST
+void state_set_capability(uint capability, bool enabled);
+
+// Call right before deleting an object, so that a later object reusing its name is bound again
+void state_forget_program(uint program);
+void state_forget_vertex_array(uint vertex_array);
+void state_forget_texture(uint texture);
+
+#endif // GLSTATE_H_
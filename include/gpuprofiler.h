@@ -0,0 +1,100 @@
+#ifndef GPUPROFILER_H_
+#define GPUPROFILER_H_
+
+#include <vector>
+#include <cstdint>
+#include "profiler.h"
+#include "framestats.h"
+
+// Frames whose queries are in flight at once, results are read this many frames later
+#define GPU_PROFILER_FRAMES 4
+
+// Zones timed per frame at most, later ones are skipped
+#define GPU_PROFILER_ZONES_PER_FRAME 256
+
+// Time the enclosing scope on the GPU, e.g. GPU_PROFILE_ZONE(gpu_profiler, "skybox");
+// The name must outlive the results, e.g. a string literal.
+#define GPU_PROFILE_ZONE(profiler, name) GpuProfileZone PROFILE_CONCAT(gpu_profile_zone_, __LINE__)(profiler, name)
+
+// Profile a pass of the frame on the CPU and the GPU and count its calls into OpenGL (see StatsPass),
+// e.g. PROFILE_PASS(gpu_profiler, "skybox");
+#define PROFILE_PASS(profiler, name) PROFILE_ZONE(name); GPU_PROFILE_ZONE(profiler, name); \
+    StatsPass PROFILE_CONCAT(stats_pass_, __LINE__)(name)
+
+// A zone timed in the latest collected frame
+struct GpuZoneTime
+{
+    const char *name;
+    float ms;
+};
+
+// Times passes on the GPU with timestamp queries written before and after each zone.
+// Timestamps rather than GL_TIME_ELAPSED, since elapsed-time queries cannot nest.
+// Queries rotate through GPU_PROFILER_FRAMES sets, and a set is only read once its results are available,
+// so reading never waits for the GPU. Results go to the "GPU" track of the CPU profiler (see profiler.h).
+class GpuProfiler
+{
+public:
+    // Create query objects, profiling is off if the driver has no timestamp counter
+    GpuProfiler();
+    ~GpuProfiler();
+
+    // Do not allow implicit copy due to OpenGL resource management
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    // Start a frame, reusing the oldest set of queries after collecting its results if they are available
+    void begin_frame();
+
+    // Write the start timestamp of a zone, returns a handle for end()
+    uint begin(const char *name);
+
+    // Write the end timestamp of a zone
+    void end(uint zone);
+
+    // Zones of the latest frame whose results arrived, in the order they began
+    const std::vector<GpuZoneTime> &latest() const;
+
+    // Also time every draw of the scene render queue, named by its model (see RenderQueue::submit)
+    bool per_draw;
+
+private:
+    // Read back the zones of a set of queries if all are available
+    void collect(uint slot);
+
+    // Query written at the start or end of a zone
+    uint query_of(uint slot, uint zone, bool end) const;
+
+    bool enabled;
+    uint64_t frame_index;
+    std::vector<const char *> zone_names[GPU_PROFILER_FRAMES]; // zones begun in each set
+    std::vector<uint> queries; // two per zone, zones of each set contiguous
+    std::vector<GpuZoneTime> latest_zones;
+    ProfilerTrack *track;
+    uint64_t frames_dropped; // results not available yet when their queries had to be reused
+};
+
+// Times the scope it lives in, see GPU_PROFILE_ZONE
+class GpuProfileZone
+{
+public:
+    GpuProfileZone(GpuProfiler &profiler, const char *name) : profiler(profiler), zone(profiler.begin(name))
+    {
+        // Left empty intentionally
+    }
+
+    ~GpuProfileZone()
+    {
+        profiler.end(zone);
+    }
+
+    // Do not allow copy, a zone ends once
+    GpuProfileZone(const GpuProfileZone&) = delete;
+    GpuProfileZone& operator=(const GpuProfileZone&) = delete;
+
+private:
+    GpuProfiler &profiler;
+    uint zone;
+};
+
+#endif // GPUPROFILER_H_
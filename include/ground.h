@@ -10,7 +10,7 @@ class Ground
 {
 public:
     // Create a ground mesh at an initial height (z axis value) and textures
-    Ground(float height, float scale, std::unique_ptr<Texture> diffuse, std::unique_ptr<Texture> specular);
+    Ground(float height, float scale, std::shared_ptr<Texture> diffuse, std::shared_ptr<Texture> specular);
 
     // Free resources
     virtual ~Ground();
@@ -23,13 +23,14 @@ public:
 
 private:
     
-    // Ground textures
-    std::unique_ptr<Texture> diffuse, specular;
+    // Ground textures, shared through TextureCache
+    std::shared_ptr<Texture> diffuse, specular;
 
     // OpenGL stuff
     uint vbuf; // Index of vertices buffer on GPU
     uint ibuf; // Index of indices buffer on GPU
     uint array_obj; // Index of array object on GPU
+    size_t gpu_bytes; // Size of the vertex and index buffers
 };
 
 #endif // GROUND_H_
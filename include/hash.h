@@ -0,0 +1,35 @@
+#ifndef HASH_H_
+#define HASH_H_
+
+#include <cstdint>
+#include <cstddef>
+
+// 64-bit FNV-1a, used for cache keys and content addressing.
+// Pass a previous result as seed to hash several buffers as one.
+const uint64_t HASH_SEED = 0xcbf29ce484222325ull;
+
+inline uint64_t hash_bytes(const void *data, size_t size, uint64_t seed = HASH_SEED)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// 32-bit FNV-1a of a null-terminated string, usable at compile time
+constexpr uint32_t hash_name(const char *name)
+{
+    uint32_t hash = 0x811c9dc5u;
+    for (; *name; name++)
+    {
+        hash ^= static_cast<unsigned char>(*name);
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+#endif // HASH_H_
@@ -0,0 +1,81 @@
+#ifndef HUD_H_
+#define HUD_H_
+
+#include <vector>
+#include <cstdint>
+#include "shaders.h"
+#include "gpuprofiler.h"
+
+// Frames shown in the frame time graph
+#define HUD_GRAPH_FRAMES 120
+
+// Seconds between refreshes of the text, which shows averages since the last refresh
+#define HUD_REFRESH_INTERVAL .25f
+
+// On-screen overlay of performance data: a frame time graph, CPU and GPU time and calls into OpenGL
+// of every pass, culling and GPU memory. Glyphs and rectangles are batched into one dynamic vertex buffer
+// and drawn with a single draw call. Text is laid out only a few times per second, the graph every frame.
+class Hud
+{
+public:
+    // Create the font texture and vertex buffer
+    Hud();
+    ~Hud();
+
+    // Do not allow implicit copy due to OpenGL resource management
+    Hud(const Hud&) = delete;
+    Hud& operator=(const Hud&) = delete;
+
+    // Record the duration of the last frame and the passes of the current one (see frame_passes),
+    // call once all passes have ended
+    void update(float delta_time);
+
+    // Draw the overlay on top of the current framebuffer
+    void draw(const Shaders &program, const GpuProfiler &gpu_profiler, uint screen_width, uint screen_height);
+
+private:
+    struct HudVertex
+    {
+        int16_t x, y; // pixels
+        uint16_t u, v; // texels of the font
+        uint32_t color; // RGBA, 8 bits each
+    };
+
+    void add_quad(int x0, int y0, int x1, int y1, uint u0, uint v0, uint u1, uint v1, uint32_t color);
+    void add_rect(int x0, int y0, int x1, int y1, uint32_t color);
+
+    // Add a line of text, lower case is drawn as upper case. Returns where the text ends.
+    int add_text(int x, int y, const char *text, uint32_t color);
+
+    // Lay out the text of the panel
+    void layout_text(const GpuProfiler &gpu_profiler);
+
+    // Frame times in milliseconds, oldest at next_frame
+    float frame_ms[HUD_GRAPH_FRAMES];
+    uint next_frame;
+
+    // Totals since the last refresh
+    float refresh_time;
+    uint refresh_frames;
+    float refresh_max_ms;
+    PassStats passes[MAX_STATS_PASSES];
+    uint num_passes;
+
+    // Values shown until the next refresh, laid out on the next draw
+    bool needs_layout;
+    FrameStats shown_stats;
+    float shown_fps, shown_ms, shown_max_ms;
+    PassStats shown_passes[MAX_STATS_PASSES];
+    uint num_shown_passes;
+
+    // Text quads come first and are kept between refreshes, graph quads are appended every frame
+    std::vector<HudVertex> vertices;
+    size_t num_text_vertices;
+
+    // OpenGL stuff
+    uint font_texture; // GL_R8, glyphs side by side
+    uint vertex_buffer;
+    uint array_obj;
+};
+
+#endif // HUD_H_
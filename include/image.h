@@ -0,0 +1,37 @@
+#ifndef IMAGE_H_
+#define IMAGE_H_
+
+#include <string>
+
+// A decoded 8-bit image in CPU memory, ready to be copied into a texture
+class Image
+{
+public:
+    // Decode an image file that is already in memory (PNG, JPEG, ...)
+    Image(const unsigned char *file_data, size_t file_size, const std::string &filepath);
+
+    // Read and decode an image file
+    Image(const std::string &filepath);
+
+    // Do not allow implicit copy, pixels are owned by a single object
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+
+    // Free pixels
+    ~Image();
+
+    // Returns false if decoding failed (an error was already printed)
+    bool is_valid() const;
+
+    // Pixel format to pass to glTexImage2D, inferred from the number of channels
+    uint gl_format() const;
+
+    // Decoded data, rows stored top to bottom as in the file
+    unsigned char *pixels;
+    int width, height, channels;
+
+    // For error messages
+    std::string filepath;
+};
+
+#endif // IMAGE_H_
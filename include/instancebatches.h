@@ -0,0 +1,38 @@
+#ifndef INSTANCEBATCHES_H_
+#define INSTANCEBATCHES_H_
+
+#include <vector>
+#include "model.h"
+
+// Groups placements of the same model file so that each group is drawn with instancing,
+// i.e. one draw call per mesh no matter how many placements share the asset.
+// Rebuilt every frame, keeping its storage so that rebuilding does not allocate.
+class InstanceBatches
+{
+public:
+    // Forget all placements of the previous frame
+    void clear();
+
+    // Add a placement to the batch of its asset, object_id is written to the picking buffer
+    void add(const Model &model, uint object_id);
+
+    // Queue all batches, skipping meshes outside the frustum if one is given.
+    // Meshes without a specular map use program_without_specular instead, if one is given.
+    void queue(RenderQueue &queue, const Shaders &program, bool with_textures,
+               const Frustum *frustum, glm::vec3 eye, const Shaders *program_without_specular = nullptr) const;
+
+    // Number of distinct assets added since the last clear
+    size_t num_batches() const;
+
+private:
+    struct Batch
+    {
+        const ModelAsset *asset;
+        std::vector<InstanceData> instances;
+    };
+
+    // Assets are few, so batches are found by linear search
+    std::vector<Batch> batches;
+};
+
+#endif // INSTANCEBATCHES_H_
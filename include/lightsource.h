@@ -2,7 +2,7 @@
 #define LIGHTSOURCE_H_
 
 #include <glm/glm.hpp>
-#include "shaders.h"
+#include "frameuniforms.h"
 
 // Point light
 class LightSource 
@@ -20,8 +20,8 @@ public:
     // Spin around starting position
     void update(float delta_time);
 
-    // Send transformations to shader
-    void use(const Shaders &program) const;
+    // Write light parameters into the per-frame uniform data
+    void use(LightData &data) const;
     
     // Draw call
     void draw() const;
@@ -0,0 +1,26 @@
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <string>
+
+// Read-only memory mapping of an entire file
+class MappedFile
+{
+public:
+    // Map file into memory, check is_open() for errors
+    MappedFile(const std::string &filepath);
+
+    // Do not allow implicit copy, the mapping is owned by a single object
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Unmap file
+    ~MappedFile();
+
+    bool is_open() const;
+
+    const unsigned char *data;
+    size_t size;
+};
+
+#endif // MAPPEDFILE_H_
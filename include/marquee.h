@@ -0,0 +1,46 @@
+#ifndef MARQUEE_H_
+#define MARQUEE_H_
+
+#include <vector>
+#include "shaders.h"
+#include "readback.h"
+
+// Finds all distinct objects inside a screen rectangle, reducing on the GPU.
+// Every pixel of the rectangle is drawn as a point into a bitmap with one bit per object ID,
+// the bits are combined with a logical OR, and only the bitmap is read back, asynchronously.
+// Its size depends on the number of objects, not on the size of the rectangle.
+class Marquee
+{
+public:
+    // Room for object IDs in [0, num_ids), window size is needed to restore the viewport
+    Marquee(uint num_ids, uint window_width, uint window_height, bool &success);
+    ~Marquee();
+
+    // Do not allow implicit copy due to OpenGL resource management
+    Marquee(const Marquee&) = delete;
+    Marquee& operator=(const Marquee&) = delete;
+
+    // Whether a reduction can start, i.e. no read back is in flight
+    bool ready() const;
+
+    // Reduce the rectangle between two framebuffer coordinates (origin at bottom left, corners included)
+    // of the given object ID texture (see Selection::ids), and start reading back the result.
+    // Re-attaches the default framebuffer afterwards.
+    void start(const Shaders &program, uint id_texture, uint x0, uint y0, uint x1, uint y1);
+
+    // If the read back has finished, gets the distinct objects inside the rectangle (never 0) and returns true.
+    // Never blocks, returns false while the GPU is still busy.
+    bool poll(std::vector<uint> &object_ids);
+
+private:
+    uint window_width, window_height;
+    uint bitmap_width, bitmap_height; // in 32-bit words
+
+    // OpenGL stuff
+    uint fbo;
+    uint texture_id; // bitmap, GL_R32UI
+    uint array_obj; // empty, points are generated in the vertex shader
+    Readback readback; // of the whole bitmap
+};
+
+#endif // MARQUEE_H_
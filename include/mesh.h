@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include "texture.h"
 #include "shaders.h"
+#include "bounds.h"
 
 struct Vertex
 {
@@ -13,6 +14,17 @@ struct Vertex
     glm::vec2 texture_coord;
 };
 
+// Bounding box and sphere of the vertex positions
+Bounds compute_bounds(const Vertex *vertices, size_t num_vertices);
+
+// Per-instance data of instanced draws, read by the vertex shader as attributes
+struct InstanceData
+{
+    glm::mat4 m; // model matrix
+    glm::mat3 m_for_normals; // transpose of inverse of the model matrix
+    uint object_id; // for picking, 0 if the instance cannot be selected
+};
+
 struct TextureHandle
 {
     uint id;
@@ -22,9 +34,11 @@ struct TextureHandle
 class Mesh
 {
 public:
-    Mesh(const std::vector<Vertex> &vertices, 
-        const std::vector<uint> &indices,
-        const std::vector<TextureHandle> &textures); 
+    // Upload vertices and indices to the GPU.
+    // Takes raw arrays so that memory-mapped data can be uploaded without copying.
+    Mesh(const Vertex *vertices, size_t num_vertices,
+        const uint *indices, size_t num_indices,
+        const std::vector<TextureHandle> &textures, const Bounds &bounds); 
 
     // Do not allow implicit copy due to OpenGL resource management
     Mesh(const Mesh&) = delete;
@@ -36,6 +50,32 @@ public:
     // Issue draw call
     void draw(const Shaders &program, bool with_textures) const;
 
+    // Read per-instance attributes from a buffer of InstanceData, one entry per instance
+    void attach_instances(uint instance_buffer) const;
+
+    // Issue a single draw call for num_instances copies, see attach_instances
+    void draw_instanced(const Shaders &program, bool with_textures, size_t num_instances) const;
+
+    // The steps of draw_instanced, so that a RenderQueue can skip the binds that change nothing
+    void bind_textures(const Shaders &program) const;
+    void bind_vertices() const;
+    void draw_elements(size_t num_instances) const;
+
+    // Index of array object on GPU
+    uint vertex_array() const;
+
+    // Whether any texture is a specular map, meshes without one can use a cheaper program
+    bool has_specular_map() const;
+
+    // Size of the vertex and index buffers on GPU, in bytes
+    size_t gpu_bytes;
+
+    // Bounding volumes in model space, for culling
+    Bounds bounds;
+
+    // Hash of the bound textures, meshes with equal values use the same textures
+    uint64_t texture_set;
+
 private:
     // OpenGL stuff
     uint vbuf; // Index of vertices buffer on GPU
@@ -0,0 +1,63 @@
+#ifndef MESHCACHE_H_
+#define MESHCACHE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "mesh.h"
+#include "mappedfile.h"
+#include "bvh.h"
+
+// Bump whenever the layout of Vertex or of the cache file changes
+#define MESH_CACHE_VERSION 3
+#define MESH_CACHE_DIRECTORY "cache/meshes/"
+
+// A texture file referenced by a mesh, relative to the model's directory
+struct TextureRef
+{
+    std::string path;
+    TextureType type;
+};
+
+// CPU-side geometry of a single mesh.
+// The vertex and index pointers view either the owned vectors below (after an assimp import)
+// or a memory-mapped cache file (on a warm start), so the data can go to the GPU without a copy.
+struct MeshData
+{
+    const Vertex *vertices = nullptr;
+    size_t num_vertices = 0;
+    const uint *indices = nullptr;
+    size_t num_indices = 0;
+    std::vector<TextureRef> textures;
+    Bounds bounds = {};
+
+    // Backing storage for imported meshes, left empty for cached ones
+    std::vector<Vertex> owned_vertices;
+    std::vector<uint> owned_indices;
+};
+
+// Everything read from a model file that is needed to build its meshes
+struct ModelData
+{
+    std::vector<MeshData> meshes;
+
+    // Keeps the cache file mapped for as long as meshes point into it
+    std::unique_ptr<MappedFile> mapping;
+    bool from_cache = false;
+
+    // Triangles of all meshes for ray casting, built after reading
+    std::shared_ptr<TriangleBVH> bvh;
+
+    // Time spent reading the file and converting meshes to our vertex format, for load reports
+    float read_ms = 0.f;
+    float convert_ms = 0.f;
+};
+
+// Try to read the meshes of a model file from its on-disk cache.
+// Returns false if there is no cache yet, or if it is stale or corrupt.
+bool load_mesh_cache(const std::string &model_path, ModelData &data);
+
+// Write the meshes of a model file to its on-disk cache, replacing any previous one
+bool save_mesh_cache(const std::string &model_path, const ModelData &data);
+
+#endif // MESHCACHE_H_
@@ -3,22 +3,28 @@
 
 #include <memory>
 #include <string>
-#include <assimp/scene.h>
 #include <glm/glm.hpp>
-#include "mesh.h"
+#include "modelasset.h"
 
+// A placement of a model file in the scene.
+// Geometry and textures live in a ModelAsset shared by all placements of the same file,
+// only the per-placement state is stored here.
 class Model
 {
 public:
 
-    // Read a 3D model file and store it in GPU memory, read to draw
+    // Place a 3D model file in the scene, loading it only if it is not resident already
     Model(const std::string &filepath);
 
-    // Draw call for every mesh in the model while activating their textures
-    void draw(const Shaders &program, bool with_textures) const;
-        
-    // Draw using a stencil trick to show outline around model
-    void draw_with_outline(const Shaders &program, const Shaders &outline) const;
+    // Draw call for every mesh in the model while activating their textures.
+    // If a frustum is given, meshes outside it are skipped.
+    void draw(const Shaders &program, bool with_textures, const Frustum *frustum = nullptr) const;
+
+    // Geometry and textures, shared with other placements of the same file
+    const ModelAsset &get_asset() const;
+
+    // Bounding sphere in world space
+    void world_bounds(glm::vec3 &center, float &radius) const;
 
     // Update model matrix (world_transform)
     void translate(float x, float y, float z);
@@ -26,29 +32,15 @@ public:
     void scale(float amount);
     void spin(float delta_time);
 
-    // Print a message about successful loading and a count of texture types
-    void print_debug_stats(const std::string &filepath);
-
     // The "Model" matrix in "Model-View-Projection" transform
     glm::mat4 world_transform;
 
+    // Whether the user has selected this placement
+    bool is_selected;
+
 private:
-    // Holds OpenGL resources for meshes and textures
-    // in a unique_ptr mostly to avoid copies and double frees
-    std::vector<std::unique_ptr<Mesh>> meshes;
-    std::vector<std::unique_ptr<Texture>> texture_pool;
-    
-    // Traverse the model file while populating this object
-    void processNode(aiNode *node, const aiScene *scene);
-    void processMesh(aiMesh *mesh, const aiScene *scene);
-
-    // Add new texture to pool lazily,
-    // i.e. if it was already loaded previously, do nothing.
-    // Returns texture id.
-    uint lazy_add_to_pool(const std::string &texture_path, TextureType type);
-    
-    // The directory of the object files, where the textures should be located
-    std::string directory;
+    // Shared geometry and textures
+    std::shared_ptr<const ModelAsset> asset;
 };
 
-#endif // MODEL_H_
\ No newline at end of file
+#endif // MODEL_H_
@@ -0,0 +1,118 @@
+#ifndef MODELASSET_H_
+#define MODELASSET_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <assimp/scene.h>
+#include "mesh.h"
+#include "meshcache.h"
+#include "frustum.h"
+#include "renderqueue.h"
+
+// Immutable GPU geometry and textures of a single model file.
+// Placements of the model in the scene (see Model) share one asset through the registry,
+// so a file that is placed N times is still imported and uploaded only once.
+class ModelAsset
+{
+public:
+    // Get the asset of a model file, loading it only if no placement currently holds it
+    static std::shared_ptr<ModelAsset> acquire(const std::string &filepath);
+
+    // Upload model data that was read ahead of time (see SceneLoader) and register the new asset
+    static std::shared_ptr<ModelAsset> create(const std::string &filepath, const ModelData &data);
+
+    // Read the meshes of a model file into CPU memory without touching OpenGL,
+    // so it is safe to call from worker threads.
+    // Meshes come from the on-disk mesh cache when it is up to date, otherwise from assimp.
+    static bool load_data(const std::string &filepath, ModelData &data);
+
+    // The directory of a model file, where its textures should be located
+    static std::string directory_of(const std::string &filepath);
+
+    // Print reference counts and GPU bytes saved by sharing, per resident asset
+    static void print_registry_stats();
+
+    // Store the meshes of a model file in GPU memory, ready to draw.
+    // Textures are fetched from TextureCache.
+    // Prefer acquire() or create() over constructing assets directly.
+    ModelAsset(const std::string &filepath, const ModelData &data);
+
+    // Do not allow implicit copy due to OpenGL resource management
+    ModelAsset(const ModelAsset&) = delete;
+    ModelAsset& operator=(const ModelAsset&) = delete;
+
+    // Free resources
+    ~ModelAsset();
+
+    // Draw call for every mesh while activating their textures.
+    // If a frustum is given, meshes outside it (once placed by transform) are skipped.
+    // Skipped meshes are not counted in frame_stats, which covers the main view only (see queue_instanced).
+    void draw(const Shaders &program, bool with_textures,
+              const Frustum *frustum = nullptr, const glm::mat4 &transform = glm::mat4(1.f)) const;
+
+    // Queue every mesh once per instance, as one draw call per mesh.
+    // Instance data goes into a buffer shared by all meshes of the asset once the queue is submitted,
+    // so instances must stay alive until then.
+    // If a frustum is given, meshes outside it for every instance are skipped.
+    // Meshes are sorted by their distance from eye to the nearest instance.
+    // Meshes without a specular map use program_without_specular instead, if one is given.
+    void queue_instanced(RenderQueue &queue, const Shaders &program, bool with_textures,
+                         const std::vector<InstanceData> &instances, const Frustum *frustum, glm::vec3 eye,
+                         const Shaders *program_without_specular = nullptr) const;
+
+    // Print a message about successful loading, load time and a count of texture types
+    void print_debug_stats(float load_ms, bool from_cache) const;
+
+    // Approximate GPU memory held by meshes and textures, in bytes
+    size_t gpu_bytes() const;
+
+    // The model file this asset was loaded from
+    const std::string filepath;
+
+    // Bounding volumes of all meshes together, in model space
+    Bounds bounds;
+
+    // Triangles of all meshes for ray casting, in model space
+    std::shared_ptr<const TriangleBVH> bvh;
+
+private:
+    // Assets currently alive, by file path.
+    // Weak references so that an asset is freed once its last placement is gone.
+    static std::unordered_map<std::string, std::weak_ptr<ModelAsset>> registry;
+
+    // Holds OpenGL resources for meshes
+    // in a unique_ptr mostly to avoid copies and double frees
+    std::vector<std::unique_ptr<Mesh>> meshes;
+
+    // Per-instance data of the last instanced draw, attached to every mesh
+    uint instance_buffer;
+    mutable size_t instance_capacity; // Number of instances the buffer has room for
+
+    // Distinct textures used by the meshes, shared with other users through TextureCache
+    std::unordered_set<std::shared_ptr<Texture>> texture_pool;
+
+    // Distinct textures by the role they play in the meshes, for debug stats
+    uint num_diffuse, num_specular;
+
+    // Import the model file with assimp, used when there is no valid mesh cache
+    static bool import(const std::string &filepath, ModelData &data);
+
+    // Build the triangle hierarchy of loaded meshes
+    static void build_bvh(ModelData &data);
+
+    // Traverse the model file while collecting mesh data
+    static void processNode(aiNode *node, const aiScene *scene, ModelData &data);
+    static void processMesh(aiMesh *mesh, const aiScene *scene, ModelData &data);
+
+    // Add texture to pool lazily,
+    // i.e. if it is resident in the texture cache already, do not load it again.
+    // Returns texture id.
+    uint lazy_add_to_pool(const std::string &texture_path);
+
+    // The directory of the object files, where the textures should be located
+    std::string directory;
+};
+
+#endif // MODELASSET_H_
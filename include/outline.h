@@ -0,0 +1,43 @@
+#ifndef OUTLINE_H_
+#define OUTLINE_H_
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "shaders.h"
+
+// Outlines selected objects in screen space, with one fullscreen pass over the object IDs of the main pass.
+// A pixel is part of the outline if it does not belong to a selected object but a nearby pixel does,
+// so the cost does not depend on how many objects are selected or how many triangles they have.
+class Outline
+{
+public:
+    Outline();
+    ~Outline();
+
+    // Do not allow implicit copy due to OpenGL resource management
+    Outline(const Outline&) = delete;
+    Outline& operator=(const Outline&) = delete;
+
+    // Whether each object is selected, indexed by object ID (0 is no object).
+    // Uploaded to the GPU only when it differs from the last call.
+    void set_selected(const std::vector<uint8_t> &selected);
+
+    // Whether any object is selected, if not there is nothing to draw
+    bool any_selected() const;
+
+    // Draw the outline over the currently bound framebuffer,
+    // reading object IDs from the given texture (see Selection::ids)
+    void draw(const Shaders &program, uint id_texture, glm::vec3 color) const;
+
+private:
+    std::vector<uint8_t> selected;
+    bool has_selected;
+
+    // OpenGL stuff
+    uint array_obj; // empty, the fullscreen triangle is generated in the vertex shader
+    uint selected_buffer; // one byte per object ID
+    uint selected_texture; // buffer texture reading selected_buffer
+};
+
+#endif // OUTLINE_H_
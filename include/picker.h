@@ -0,0 +1,43 @@
+#ifndef PICKER_H_
+#define PICKER_H_
+
+#include <memory>
+#include <vector>
+#include "model.h"
+#include "bvh.h"
+
+// Where a ray hit the scene
+struct RayHit
+{
+    uint object; // index of the placement in the scene
+    uint triangle; // index of the triangle in the placement's model, counted over all meshes
+    float distance; // along the ray, in world units for a normalized direction
+};
+
+// Picks objects by casting rays against their triangles on the CPU, with no GPU round trip.
+// A hierarchy over placements leads to the triangle hierarchies of their models, shared by all placements.
+class RayPicker
+{
+public:
+    // Build the hierarchy over the current placements of a scene
+    void build(const std::vector<std::unique_ptr<Model>> &scene);
+
+    // Update world bounds after placements moved, the scene must hold the same placements as when built
+    void refit(const std::vector<std::unique_ptr<Model>> &scene);
+
+    // Nearest placement hit by the ray, returns false if none
+    bool cast(const Ray &ray, RayHit &hit) const;
+
+private:
+    struct Placement
+    {
+        const TriangleBVH *bvh;
+        glm::mat4 world_to_model;
+    };
+
+    SceneBVH hierarchy;
+    std::vector<Placement> placements;
+    std::vector<Box> world_boxes;
+};
+
+#endif // PICKER_H_
@@ -0,0 +1,70 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Scoped CPU profiling zones, exported as Chrome trace events (open in chrome://tracing or ui.perfetto.dev).
+// Zones nest by time, so a zone inside another shows below it. Recording takes two clock reads and three stores,
+// cheap enough to always stay on. Each thread writes into its own ring buffer without locks,
+// keeping only its latest PROFILER_EVENTS_PER_THREAD zones.
+#define PROFILER_EVENTS_PER_THREAD 16384
+
+// Time the enclosing scope, e.g. PROFILE_ZONE("skybox");
+// The name must be a string literal, only its pointer is recorded.
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_CONCAT_INNER(a, b) a##b
+
+// Nanoseconds of a steady clock
+inline uint64_t profiler_now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Record a finished zone into the calling thread's ring buffer
+void profiler_record(const char *name, uint64_t start_ns, uint64_t end_ns);
+
+// Name the calling thread in exported traces
+void profiler_set_thread_name(const std::string &name);
+
+// A track of zones not measured on a thread's own clock, e.g. GPU work, shown next to the threads.
+// Like a thread's buffer, a track must only be recorded into by one thread.
+struct ThreadEvents;
+typedef ThreadEvents ProfilerTrack;
+
+// Add a named track, kept until exit. Threads get their own unnamed one when they first record.
+ProfilerTrack *profiler_add_track(const std::string &name);
+
+// Record a finished zone into a track, times on the clock of profiler_now()
+void profiler_record(ProfilerTrack *track, const char *name, uint64_t start_ns, uint64_t end_ns);
+
+// Write the zones recorded by all threads as Chrome trace-event JSON, may be called while threads record
+bool profiler_export(const std::string &filepath);
+
+// Records the time from construction to destruction, see PROFILE_ZONE
+class ProfileZone
+{
+public:
+    ProfileZone(const char *name) : name(name), start_ns(profiler_now())
+    {
+        // Left empty intentionally
+    }
+
+    ~ProfileZone()
+    {
+        profiler_record(name, start_ns, profiler_now());
+    }
+
+    // Do not allow copy, a zone records once
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char *name;
+    uint64_t start_ns;
+};
+
+#endif // PROFILER_H_
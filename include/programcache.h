@@ -0,0 +1,31 @@
+#ifndef PROGRAMCACHE_H_
+#define PROGRAMCACHE_H_
+
+#include <cstdint>
+#include <string>
+
+// Bump whenever the layout of the cache file changes
+#define PROGRAM_CACHE_VERSION 1
+#define PROGRAM_CACHE_DIRECTORY "cache/programs/"
+
+// Linked shader programs saved as driver-specific binaries (GL_ARB_get_program_binary),
+// so that warm starts skip GLSL compilation and linking entirely.
+// Entries are keyed by a hash of the program's sources and the driver that built it,
+// a binary the driver rejects anyway (e.g. after an update) is simply rebuilt.
+
+// Whether the driver can save and load program binaries at all.
+// Always false if GLAD was generated without GL_ARB_get_program_binary.
+bool program_cache_supported();
+
+// Hash of the vendor, renderer and version strings of the current context, part of every key
+uint64_t driver_hash();
+
+// Try to load a cached binary into the program object and check that it links.
+// On success, gets the time it took to build the program from source when it was saved.
+bool load_program_cache(uint program, uint64_t key, float &build_ms);
+
+// Save the binary of a linked program, replacing any previous one.
+// The program must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+bool save_program_cache(uint program, uint64_t key, float build_ms);
+
+#endif // PROGRAMCACHE_H_
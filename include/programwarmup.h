@@ -0,0 +1,46 @@
+#ifndef PROGRAMWARMUP_H_
+#define PROGRAMWARMUP_H_
+
+#include <vector>
+#include <chrono>
+#include "shaders.h"
+
+// Finishes shader programs in the background of the render loop, while frames are already being drawn.
+// Each program is finished once the driver is done building it, then drawn with once off-screen,
+// so that neither the build nor the driver's deferred work lands on the frame that first uses it.
+// Until then, the render loop skips (or replaces) draws with programs that are not usable().
+class ProgramWarmup
+{
+public:
+    ProgramWarmup(bool &success);
+    ~ProgramWarmup();
+
+    // Do not allow implicit copy due to OpenGL resource management
+    ProgramWarmup(const ProgramWarmup&) = delete;
+    ProgramWarmup& operator=(const ProgramWarmup&) = delete;
+
+    // Track a program, in order of priority
+    void add(Shaders &program);
+
+    // Finish and warm up programs that are ready, call once per frame.
+    // If the driver cannot build in parallel, at most one program is finished per frame to spread the cost.
+    // Returns false if a program failed to build.
+    bool update();
+
+    // Whether every program is usable
+    bool done() const;
+
+private:
+    std::vector<Shaders *> pending;
+    uint num_programs;
+    uint num_frames;
+    bool reported; // startup programs are all ready, later ones are variants built on demand
+    std::chrono::steady_clock::time_point start_time;
+
+    // OpenGL stuff
+    uint fbo; // 1x1, with the same attachments as the main pass
+    uint color_renderbuffer_id, id_renderbuffer_id, depth_renderbuffer_id;
+    uint array_obj; // no attributes enabled
+};
+
+#endif // PROGRAMWARMUP_H_
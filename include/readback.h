@@ -0,0 +1,38 @@
+#ifndef READBACK_H_
+#define READBACK_H_
+
+#include <sys/types.h>
+
+// Reads unsigned integer pixels (GL_RED_INTEGER) back from the GPU without the CPU ever waiting for it.
+// Pixels are copied into a pixel buffer, and a fence tells when the copy is done and the buffer can be mapped.
+class Readback
+{
+public:
+    // Room for up to size bytes of pixels
+    Readback(size_t size);
+    ~Readback();
+
+    // Do not allow implicit copy due to OpenGL resource management
+    Readback(const Readback&) = delete;
+    Readback& operator=(const Readback&) = delete;
+
+    // Whether a read back is in flight
+    bool busy() const;
+
+    // Start copying a rectangle of the currently bound read buffer, which returns immediately
+    void start(uint x, uint y, uint width, uint height);
+
+    // If the copy has finished, maps the pixels into data (null if mapping failed) and returns true.
+    // Call unmap() once done reading them. Never blocks, returns false while the GPU is still busy.
+    bool poll(const uint *&data);
+    void unmap();
+
+private:
+    size_t size;
+
+    // OpenGL stuff
+    uint pixel_buffer; // destination of the copy
+    void *fence; // signaled once the copy is done, null if none is in flight
+};
+
+#endif // READBACK_H_
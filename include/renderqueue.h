@@ -0,0 +1,69 @@
+#ifndef RENDERQUEUE_H_
+#define RENDERQUEUE_H_
+
+#include <vector>
+#include <cstdint>
+#include "mesh.h"
+#include "shaders.h"
+
+class GpuProfiler;
+
+// An instanced draw call waiting in a RenderQueue
+struct DrawPacket
+{
+    // Bits 63-56: program, 55-40: texture set, 39-24: vertex array, 23-0: depth (front to back)
+    uint64_t key;
+    const Shaders *program;
+    const Mesh *mesh;
+    uint num_instances;
+    bool with_textures;
+    const char *label; // names the draw when timed on the GPU, may be null
+    uint upload; // index of the instance data the draw reads
+};
+
+// Instance data waiting in a RenderQueue, uploaded right before the first draw that reads it
+struct InstanceUpload
+{
+    uint buffer;
+    const std::vector<InstanceData> *instances;
+    const size_t *capacity; // of the buffer, in instances
+};
+
+// Collects the draw calls of a pass and issues them sorted by state, then by depth,
+// so that programs, textures and vertex arrays are bound as rarely as possible
+// and near geometry fills the depth buffer first.
+// Instance data is only read at submit(), so the same buffer can be queued more than once per pass.
+class RenderQueue
+{
+public:
+    // Forget all packets of the previous frame, keeping storage
+    void clear();
+
+    // Queue instance data for a buffer with room for capacity instances (see Mesh::attach_instances).
+    // Instances must stay alive until submit(). Returns the upload to pass to push().
+    uint add_instances(uint buffer, const std::vector<InstanceData> &instances, const size_t &capacity);
+
+    // Queue an instanced draw of a mesh reading the instances of an upload, depth is the distance from the camera
+    void push(const Shaders &program, const Mesh &mesh, uint upload, bool with_textures, float depth,
+              const char *label = nullptr);
+
+    // Sort and issue all queued draw calls, each timed on the GPU if a profiler is given
+    void submit(GpuProfiler *gpu_profiler = nullptr);
+
+    // Farthest depth that is still told apart when sorting
+    static constexpr float MAX_DEPTH = 100.f;
+
+private:
+    std::vector<DrawPacket> packets;
+    std::vector<InstanceUpload> uploads;
+
+    // Upload each buffer currently holds while submitting, as (buffer, upload) pairs
+    std::vector<std::pair<uint, uint>> buffer_contents;
+    void upload_instances(uint upload);
+
+    // Programs seen so far, their index is the program field of the sort key
+    std::vector<const Shaders *> programs;
+    uint64_t program_index(const Shaders &program);
+};
+
+#endif // RENDERQUEUE_H_
@@ -0,0 +1,72 @@
+#ifndef SCENELOADER_H_
+#define SCENELOADER_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "modelasset.h"
+#include "threadpool.h"
+
+// Loads many model files at once.
+// File reading, assimp import, vertex conversion and image decoding run on a pool of worker threads,
+// only the final OpenGL object creation and uploads happen on the calling (GL) thread.
+class SceneLoader
+{
+public:
+    // Start worker threads, 0 means one per hardware thread
+    SceneLoader(uint num_threads = 0);
+
+    // Queue a model file, requesting the same file twice loads it once
+    void request(const std::string &filepath);
+
+    // Load every requested model and register it as a ModelAsset, see ModelAsset::acquire().
+    // Loaded assets and textures stay resident at least as long as this loader.
+    void load_all();
+
+    // Print wall-clock time of the last load_all() and a per-asset timing breakdown
+    void print_timings() const;
+
+private:
+    // A texture file decoded on a worker
+    struct PendingTexture
+    {
+        std::string path;
+        size_t owner; // index of the asset that requested it first, which is billed its time
+        bool hashed;
+        uint64_t hash;
+        std::unique_ptr<Image> image;
+        float decode_ms;
+    };
+
+    // A model file read on a worker, with timings of every loading stage
+    struct PendingAsset
+    {
+        std::string filepath;
+        ModelData data;
+        uint num_textures;
+        float decode_ms;
+        float upload_ms;
+    };
+
+    // Worker tasks
+    void read_model(size_t index);
+    void decode_texture(PendingTexture *texture);
+
+    ThreadPool pool;
+    std::vector<PendingAsset> pending;
+
+    // Textures claimed by some worker, guarded by mutex since models discover them concurrently
+    std::mutex mutex;
+    std::unordered_set<std::string> claimed_textures;
+    std::vector<std::unique_ptr<PendingTexture>> pending_textures;
+
+    // Results, holding references so that nothing is freed before placements take over
+    std::vector<std::shared_ptr<ModelAsset>> assets;
+    std::vector<std::shared_ptr<Texture>> textures;
+    float cpu_ms, total_ms;
+};
+
+#endif // SCENELOADER_H_
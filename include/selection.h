@@ -2,8 +2,12 @@
 #define SELECTION_H_
 
 #include <glm/glm.hpp>
+#include "readback.h"
 
-// A mechanism for selecting objects by rendering to a texture object IDs in a second render pass
+// A mechanism for selecting objects by rendering object IDs to a texture.
+// IDs are either written by the main pass itself as a second render target (see start_scene),
+// or by a separate pass that runs only when needed, restricted to the pixel under the cursor (see start).
+// Either way the ID of one pixel is read back asynchronously, so the CPU never waits for the GPU.
 class Selection
 {
 public:
@@ -13,22 +17,66 @@ public:
     // Do not allow implicit copy due to OpenGL resource management
     Selection(const Selection&) = delete;
     Selection& operator=(const Selection&) = delete;
+
+    // Ask for the object at the (x,y) framebuffer coordinate (origin at bottom left).
+    // A click takes precedence over hovering when both are pending.
+    void request_pick(uint x, uint y);
+    void request_hover(uint x, uint y);
+
+    // Whether a separate ID pass should run this frame,
+    // i.e. a read is requested and no read back is in flight
+    bool needs_pass() const;
+
+    // Coordinate of the pixel being read
+    uint read_x, read_y;
+
+    // Texture of object IDs written by the last pass (GL_R32UI, 0 where there is no object)
+    uint ids() const;
+
+    // Attaches the scene framebuffer, so that the main pass renders color and object IDs together
+    void start_scene() const;
+
+    // Starts reading back a requested pixel of the IDs written by the main pass if read_ids is set,
+    // then copies color to the default framebuffer and re-attaches it.
+    // Otherwise requests stay pending for the separate ID pass.
+    void end_scene(bool read_ids);
     
-    // Attaches selection framebuffer, so that following draw calls render off-screen to selection buffer
-    void start() const;
-    
-    // Re-attaches to default framebuffer so that following draw calls render to screen
-    void end() const;
+    // Attaches selection framebuffer, so that following draw calls render only object IDs off-screen,
+    // only to the pixel being read
+    void start();
     
-    // Gets the index of the object at the (x,y) screen coordinate
-    // Must be called only between start() and end()
-    uint object_at(int x, int y) const;
+    // Starts reading back the pixel and re-attaches to default framebuffer
+    // so that following draw calls render to screen
+    void end();
+
+    // If the read back of the last pass has finished, gets the index of the object at the pixel and returns true.
+    // is_click tells whether it answers request_pick or request_hover.
+    // Never blocks, returns false while the GPU is still busy.
+    bool poll(uint &object_id, bool &is_click);
 
 private:
+    uint width, height;
+
     // OpenGL stuff
-    uint fbo; // framebuffer
-    uint texture_id; // color buffer
-    uint renderbuffer_id; // depth+stencil buffer
+    uint fbo; // framebuffer of the separate ID pass
+    uint scene_fbo; // framebuffer of the main pass, with color and IDs
+    uint texture_id; // object IDs, attached to both framebuffers
+    uint color_renderbuffer_id; // color buffer of the main pass
+    uint renderbuffer_id; // depth+stencil buffer, attached to both framebuffers
+    Readback readback; // of a single ID
+
+    // Pending requests
+    bool click_requested, hover_requested;
+    uint click_x, click_y;
+    uint hover_x, hover_y;
+    bool reading_click;
+
+    // Size of all buffers on GPU, in bytes
+    size_t gpu_bytes() const;
+
+    // Choose the pixel to read among pending requests
+    void choose_read();
+
 };
 
 #endif // SELECTION_H_
@@ -2,15 +2,35 @@
 #define SHADERS_H_
 
 #include <string>
+#include <vector>
+#include <chrono>
 #include <glm/glm.hpp>
+#include "hash.h"
 #include "texture.h"
+#include "shadersource.h"
+
+// Handle to a uniform by name, hashed at compile time when built from a string literal,
+// so that setting a uniform involves no string building, no allocation and no driver lookup
+struct Uniform
+{
+    template <size_t N>
+    constexpr Uniform(const char (&name)[N]) : hash(hash_name(name))
+    {
+        // Left empty intentionally
+    }
+
+    uint32_t hash;
+};
 
 class Shaders
 {
     public:
-        // Reads, compiles and links shader program
-        // Make sure to check last argument for any errors
-        Shaders(const std::string &vertex_shader_path, const std::string &fragment_shader_path, bool &success);
+        // Reads shader sources and starts compiling and linking them, or loads the program from the binary cache.
+        // Returns without waiting for the driver, success tells only whether the sources were found.
+        // The program can be used once ready() and finish() both returned true (see ProgramWarmup).
+        // Preprocessor definitions, if given, go right after the #version line of the fragment shader (see ShaderVariants).
+        Shaders(const std::string &vertex_shader_path, const std::string &fragment_shader_path, bool &success,
+                const std::string &fragment_defines = "");
 
         // Do not allow implicit copy due to OpenGL resource management
         Shaders(const Shaders&) = delete;
@@ -19,24 +39,84 @@ class Shaders
         // Frees resources
         ~Shaders();
 
+        // Whether the driver is done building, so that finish() would not block
+        bool ready() const;
+
+        // Check compile and link errors and prepare the program for use, blocking if not ready() yet.
+        // Returns false (after printing the errors) if the program cannot be used.
+        bool finish();
+
+        // Whether finish() succeeded
+        bool usable() const;
+
+        // Issue a draw that covers no pixel, so that the driver does any deferred work before the first real draw.
+        // Expects the framebuffer and an attribute-less vertex array bound.
+        void warm_up() const;
+
+        // Whether the driver can build programs on background threads (GL_KHR_parallel_shader_compile).
+        // Always false if GLAD was generated without the extension.
+        static bool parallel_compile_supported();
+
+        // Ask the driver to build programs on background threads, if it can
+        static void enable_parallel_compile();
+
         // Activate program
         void use() const;
         
-        // Send model, view, projection matrices to the program as uniforms
-        void set_transforms(const glm::mat4 &model, const glm::mat4 &view, const glm::mat4 &projection) const;
+        // Send model matrix to the program as uniforms (view and projection come from the FrameData block)
+        void set_transforms(const glm::mat4 &model) const;
 
         // Send uniform data to shaders
-        void uniform_vec3(const std::string &uniform_name, glm::vec3 v) const;
-        void uniform_vec4(const std::string &uniform_name, glm::vec4 v) const;
-        void uniform_mat4(const std::string &uniform_name, glm::mat4 matrix) const;
-        void uniform_mat3(const std::string &uniform_name, glm::mat3 matrix) const;
-        void uniform_float(const std::string &uniform_name, float f) const;
-        void uniform_modulation(const std::string &uniform_name) const;
-        void uniform_int(const std::string &uniform_name, int i) const;
-        void uniform_uint(const std::string &uniform_name, uint u) const;
+        void uniform_vec3(Uniform uniform, glm::vec3 v) const;
+        void uniform_vec4(Uniform uniform, glm::vec4 v) const;
+        void uniform_mat4(Uniform uniform, glm::mat4 matrix) const;
+        void uniform_mat3(Uniform uniform, glm::mat3 matrix) const;
+        void uniform_float(Uniform uniform, float f) const;
+        void uniform_modulation(Uniform uniform) const;
+        void uniform_int(Uniform uniform, int i) const;
+        void uniform_uint(Uniform uniform, uint u) const;
+
+        // Number of uniform locations looked up by name through the driver, since startup.
+        // Locations are resolved once at link time, so this must not grow while rendering.
+        static uint location_queries;
+
+        // Shader objects are compiled once per source file and kept for later programs.
+        // Call once no more programs will be built to free them (see ProgramWarmup).
+        static void release_shader_objects();
+
+        // Print how programs were built and the startup time saved by the binary cache (see programcache.h)
+        static void print_stats();
+
+        // Build counters since startup
+        static uint shaders_compiled, shaders_reused, programs_built, programs_from_cache;
+        static float build_ms, saved_ms;
 
     private:
         int id; // OpenGL program index
+
+        // Files the program was built from, without their text, for error messages
+        ShaderSource vertex_files, fragment_files;
+
+        // Build state, kept until finish()
+        uint vertex_shader, fragment_shader;
+        uint64_t key; // in the binary cache
+        bool from_cache;
+        bool finished;
+        float cached_build_ms; // time it took to build from source, when loaded from the binary cache
+        float main_thread_ms; // time spent building on this thread, excluding any driver threads
+        std::chrono::steady_clock::time_point submit_time;
+        mutable float ready_ms; // wall-clock time from submit until ready() first saw the driver done, or -1
+
+        // Locations of all active uniforms, sorted by name hash, filled once after linking
+        std::vector<std::pair<uint32_t, int>> locations;
+        std::vector<int> samplers; // locations of sampler uniforms only
+        void resolve_locations();
+
+        // Attach the FrameData uniform block, if the program declares it, to the shared buffer
+        void bind_frame_data() const;
+
+        // Location of a uniform, or -1 if the program does not use it
+        int location_of(Uniform uniform) const;
 };
 
 #endif // SHADERS_H_
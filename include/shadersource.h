@@ -0,0 +1,35 @@
+#ifndef SHADERSOURCE_H_
+#define SHADERSOURCE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A shader file with every #include "path" directive replaced by the contents of that file.
+// Paths are relative to the including file, and each file is included at most once.
+// Line numbers in compile errors read "source:line", where source indexes files below.
+struct ShaderSource
+{
+    std::string text;
+    uint64_t hash = 0; // of text
+
+    // The file itself first, then every file it includes in order of inclusion, with their write times when read
+    std::vector<std::string> files;
+    std::vector<int64_t> write_times;
+};
+
+// Get the preprocessed source of a shader file, of any size.
+// Sources are cached, a file and its includes are read again only if one of them changed on disk.
+// Returns null (after printing the error) if a file cannot be read.
+const ShaderSource *load_shader_source(const std::string &shader_path);
+
+// Whether any file the source was built from changed on disk since it was read
+bool source_changed(const ShaderSource &source);
+
+// Copy of a source with preprocessor definitions inserted right after its #version line
+ShaderSource with_defines(const ShaderSource &source, const std::string &defines);
+
+// Print which file each source number in compile errors stands for
+void print_source_files(const ShaderSource &source);
+
+#endif // SHADERSOURCE_H_
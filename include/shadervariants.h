@@ -0,0 +1,51 @@
+#ifndef SHADERVARIANTS_H_
+#define SHADERVARIANTS_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "shaders.h"
+#include "programwarmup.h"
+
+// Features a fragment shader can leave out at compile time, combined as bits.
+// Each bit turns into a #define of the same name (see ShaderVariants::defines_of).
+enum ShaderFeature : uint
+{
+    FEATURE_SUN = 1 << 0,
+    FEATURE_FLASHLIGHT = 1 << 1,
+    FEATURE_POINT_LIGHT = 1 << 2,
+    FEATURE_SPECULAR_MAP = 1 << 3,
+    ALL_FEATURES = (1 << 4) - 1
+};
+
+// Programs built from one pair of shader files, one per combination of features that is actually drawn,
+// so that disabled features cost no instructions instead of being multiplied by zero.
+// Variants are built lazily in the background (see ProgramWarmup). Until one is ready,
+// the variant with all features stands in for it, which the shader must keep correct for any combination.
+class ShaderVariants
+{
+public:
+    // Starts building the variant with all features right away
+    ShaderVariants(const std::string &vertex_shader_path, const std::string &fragment_shader_path,
+                   ProgramWarmup &warmup, bool &success);
+
+    // The variant with exactly these features if it is usable, otherwise the variant with all features.
+    // The first call for a combination starts building its variant.
+    const Shaders &get(uint features);
+
+    // Number of variants built or being built
+    size_t size() const;
+
+    // Preprocessor definitions of a combination of features
+    static std::string defines_of(uint features);
+
+private:
+    std::string vertex_shader_path, fragment_shader_path;
+    ProgramWarmup &warmup;
+    std::unordered_map<uint, std::unique_ptr<Shaders>> variants;
+
+    // Create a variant and hand it to the warmup
+    Shaders *build(uint features, bool &success);
+};
+
+#endif // SHADERVARIANTS_H_
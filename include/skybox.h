@@ -1,16 +1,15 @@
 #ifndef SKYBOX_H_
 #define SKYBOX_H_
 
-#include <string>
 #include "shaders.h"
 #include "cubemap.h"
 
 class Skybox
 {
 public:
-    // Initialize a textured skybox. Texture files must be inside the directory with the following filenames:
-    // right.jpg, left.jpg, top.jpg, bottom.jpg, front.jpg, back.jpg 
-    Skybox(std::string textures_directory);
+    // Initialize skybox geometry. The cubemap is chosen per draw call (see SkyboxLibrary),
+    // so that switching skyboxes does not need new geometry.
+    Skybox();
 
     // Free resources
     ~Skybox();
@@ -20,14 +19,14 @@ public:
     Skybox& operator=(const Skybox&) = delete;
     
     // Issue draw call
-    void draw(const Shaders &program, const glm::mat4 &view_matrix, const glm::mat4 &proj_matrix) const;
+    // Camera transformations are read from the FrameData block
+    void draw(const Shaders &program, const CubeMap &texture) const;
 
 private:
     // OpenGL stuff
     uint vbuf; // Index of vertices buffer on GPU
     uint array_obj; // Index of array object on GPU
-
-    CubeMap texture;
+    size_t gpu_bytes; // Size of the vertex buffer
 };
 
 #endif  // SKYBOX_H_
@@ -0,0 +1,65 @@
+#ifndef SKYBOXLIBRARY_H_
+#define SKYBOXLIBRARY_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "cubemap.h"
+#include "threadpool.h"
+
+// All skyboxes found in a directory, made resident on demand.
+// Only the selected skybox, the one shown while it loads, and the next one in the cycle
+// are kept on the GPU. Faces are decoded on a background thread, so selecting another
+// skybox never blocks a frame: the previous one stays on screen until the new one is ready.
+class SkyboxLibrary
+{
+public:
+    // List the skybox directories and load the first one right away
+    SkyboxLibrary(const std::string &skyboxes_directory);
+
+    // Do not allow copy, the background thread refers back to this object
+    SkyboxLibrary(const SkyboxLibrary&) = delete;
+    SkyboxLibrary& operator=(const SkyboxLibrary&) = delete;
+
+    // Number of skyboxes available
+    uint size() const;
+
+    // Request the skybox to show, returns immediately
+    void select(uint index);
+
+    // Must be called once per frame on the OpenGL thread:
+    // uploads faces the background thread has finished decoding, evicts unused skyboxes
+    // and starts decoding whatever is needed next
+    void update();
+
+    // Cubemap to draw this frame
+    const CubeMap &current() const;
+
+private:
+    // Faces of one skybox, decoded by the background thread
+    struct DecodedSkybox
+    {
+        uint index;
+        uint64_t hash;
+        std::vector<std::unique_ptr<Image>> faces;
+    };
+
+    uint next_of(uint index) const;
+    void start_decoding(uint index);
+
+    std::vector<std::string> directories;
+    std::vector<std::shared_ptr<CubeMap>> resident; // empty where not resident
+    uint shown, selected;
+
+    // Background decoding, one skybox at a time
+    bool decoding;
+    std::mutex mutex;
+    std::unique_ptr<DecodedSkybox> decoded; // guarded by mutex
+
+    // Declared last so that it is destroyed first, finishing any task that still uses the members above
+    ThreadPool background;
+};
+
+#endif // SKYBOXLIBRARY_H_
@@ -2,14 +2,16 @@
 #define SUN_H_
 
 #include <glm/glm.hpp>
-#include "shaders.h"
+#include "frameuniforms.h"
 
 class Sun
 {
 public:
     // Construct sun
     Sun(glm::vec3 direction);
-    void use(const Shaders &program) const;
+
+    // Write light parameters into the per-frame uniform data
+    void use(LightData &data) const;
 
 private:
     glm::vec3 direction;
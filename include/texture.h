@@ -2,7 +2,9 @@
 #define TEXTURE_H_
 
 #include <string>
+#include "image.h"
 
+// The role a texture plays in a mesh. A texture itself has none, since the same file may be used for both.
 enum class TextureType 
 {
     Diffuse,
@@ -13,7 +15,10 @@ class Texture
 {
 public:
     // Load texture from image file
-    Texture(const std::string &texture_path, TextureType type);
+    Texture(const std::string &texture_path);
+
+    // Copy an already decoded image into a new texture
+    Texture(const Image &image);
     
     // Do not allow implicit copy due to OpenGL resource management
     Texture(const Texture&) = delete;
@@ -28,9 +33,11 @@ public:
     // OpenGL index of texture
     uint id;
 
+    // Approximate size on GPU including mipmaps, in bytes
+    size_t gpu_bytes;
+
     // Misc members
     std::string filepath;
-    TextureType type;
 };
 
 
@@ -0,0 +1,61 @@
+#ifndef TEXTURECACHE_H_
+#define TEXTURECACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "texture.h"
+#include "cubemap.h"
+#include "mappedfile.h"
+
+// Process-wide cache of GPU textures, addressed by the content hash of their image files.
+// Files that are byte-identical share one texture even when they live under different paths.
+// Entries are weak references, so a texture is freed once nothing uses it anymore.
+class TextureCache
+{
+public:
+    // Get the texture of an image file, decoding and uploading it only on a miss
+    static std::shared_ptr<Texture> get(const std::string &texture_path);
+
+    // Upload an image that was decoded ahead of time (see SceneLoader),
+    // unless a texture with the same content hash is resident already
+    static std::shared_ptr<Texture> insert(const std::string &texture_path, uint64_t content_hash, const Image &image);
+
+    // Get the cubemap of a directory holding six face images, see CubeMap
+    static std::shared_ptr<CubeMap> get_cubemap(const std::string &texture_directory);
+
+    // Map, hash and decode the six faces of a cubemap directory without touching OpenGL or the cache,
+    // so it is safe to call from a background thread. Pass the result to insert_cubemap().
+    static void read_cubemap(const std::string &texture_directory, uint64_t &content_hash, std::vector<std::unique_ptr<Image>> &faces);
+
+    // Upload cubemap faces that were decoded ahead of time,
+    // unless a cubemap with the same content hash is resident already
+    static std::shared_ptr<CubeMap> insert_cubemap(uint64_t content_hash, const std::vector<std::unique_ptr<Image>> &faces);
+
+    // Sum of the GPU memory of all resident textures and cubemaps, in bytes
+    static size_t resident_bytes();
+
+    // Print hit/miss counters and resident memory
+    static void print_stats();
+
+    // Lookup counters since startup
+    static uint hits, misses;
+
+private:
+    // Resident textures and cubemaps by content hash
+    static std::unordered_map<uint64_t, std::weak_ptr<Texture>> textures;
+    static std::unordered_map<uint64_t, std::weak_ptr<CubeMap>> cubemaps;
+
+    // Map the face files of a cubemap directory and hash their contents together
+    static uint64_t map_cubemap(const std::string &texture_directory, std::vector<std::unique_ptr<MappedFile>> &files);
+
+    // Decode cubemap faces from their mapped files
+    static void decode_cubemap(const std::string &texture_directory, const std::vector<std::unique_ptr<MappedFile>> &files, 
+                               std::vector<std::unique_ptr<Image>> &faces);
+
+    // Content hash of every path requested so far, so that repeated requests skip reading the file
+    static std::unordered_map<std::string, uint64_t> path_hashes;
+};
+
+#endif // TEXTURECACHE_H_
@@ -0,0 +1,46 @@
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads running queued tasks in submission order
+class ThreadPool
+{
+public:
+    // Start worker threads, 0 means one per hardware thread
+    ThreadPool(uint num_threads = 0);
+
+    // Do not allow copy, workers refer back to this object
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Finish all queued tasks, then join workers
+    ~ThreadPool();
+
+    // Queue a task, may be called from within another task
+    void submit(std::function<void()> task);
+
+    // Block until every submitted task has finished, including tasks submitted meanwhile
+    void wait();
+
+    // Number of worker threads
+    uint size() const;
+
+private:
+    void worker_loop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_available; // signaled on submit and on shutdown
+    std::condition_variable all_done; // signaled when the queue drains and no task is running
+    uint num_running;
+    bool stopping;
+};
+
+#endif // THREADPOOL_H_
@@ -6,8 +6,9 @@ class Window
 {
     public:
         // Create window with OpenGL context
+        // A headless window has no surface and no input, it renders off-screen through OSMesa without vsync
         // Make sure to check last argument to verify there were no errors
-        Window(uint width, uint height, bool &success);
+        Window(uint width, uint height, bool headless, bool &success);
 
         // Free resources
         ~Window();
@@ -1,6 +1,9 @@
 #version 330 core
 
-out vec4 fragColor;
+flat in uint vertex_object_id;
+
+layout (location = 0) out vec4 fragColor;
+layout (location = 1) out uint fragObjectID; // read for picking when the main pass renders to Selection
 
 float near = 0.1;
 float far = 100.0;
@@ -17,4 +20,5 @@ void main()
     depth = (depth - near) / (far - near);
 
     fragColor = vec4(vec3(depth), 1.0);
+    fragObjectID = vertex_object_id;
 }
@@ -3,15 +3,20 @@
 in vec3 vertex_normal; // in world space
 in vec3 vertex_position; // in world space
 
+#include "include/frame_data.glsl"
+
 uniform samplerCube cubemap;
-uniform vec3 camera_position; // in world space
 
-out vec4 fragColor;
+flat in uint vertex_object_id;
+
+layout (location = 0) out vec4 fragColor;
+layout (location = 1) out uint fragObjectID; // read for picking when the main pass renders to Selection
 
 void main()
 {
     float ior = 1.0 / 1.52; // Approximately air to glass index of refraction ratio
-    vec3 camera_direction = normalize(vertex_position - camera_position);
+    vec3 camera_direction = normalize(vertex_position - camera_position.xyz);
     vec3 refracted_direction = refract(camera_direction, vertex_normal, ior);
     fragColor = vec4(texture(cubemap, refracted_direction).rgb, 1.0);
+    fragObjectID = vertex_object_id;
 }
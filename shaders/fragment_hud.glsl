@@ -0,0 +1,18 @@
+#version 330 core
+
+uniform sampler2D font; // coverage in red, with a solid glyph for rectangles
+
+in vec2 texture_coord;
+in vec4 vertex_color;
+
+out vec4 fragColor;
+
+void main()
+{
+    float coverage = texture(font, texture_coord).r;
+    if (coverage == 0.0)
+    {
+        discard;
+    }
+    fragColor = vec4(vertex_color.rgb, vertex_color.a * coverage);
+}
@@ -1,9 +1,13 @@
 #version 330 core
 
 uniform vec3 color;
-out vec4 fragColor;
+flat in uint vertex_object_id;
+
+layout (location = 0) out vec4 fragColor;
+layout (location = 1) out uint fragObjectID; // read for picking when the main pass renders to Selection
 
 void main()
 {
     fragColor = vec4(color, 1.0);
+    fragObjectID = vertex_object_id;
 }
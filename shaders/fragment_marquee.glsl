@@ -0,0 +1,10 @@
+#version 330 core
+
+flat in uint bit;
+
+out uint fragBits; // combined with the bitmap by a logical OR
+
+void main()
+{
+    fragBits = bit;
+}
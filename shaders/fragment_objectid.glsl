@@ -1,10 +1,10 @@
 #version 330 core
 
-uniform uint object_id; 
+flat in uint vertex_object_id;
 
 out uint fragColor;
 
 void main()
 {
-    fragColor = object_id;
+    fragColor = vertex_object_id;
 }
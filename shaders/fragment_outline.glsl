@@ -0,0 +1,42 @@
+#version 330 core
+
+uniform vec3 color;
+uniform usampler2D object_ids; // written by the main pass, 0 where there is no object
+uniform usamplerBuffer selected; // 1 for selected objects, indexed by object ID
+
+out vec4 fragColor;
+
+// Outline thickness in pixels
+const int RADIUS = 3;
+
+bool is_selected(uint object_id)
+{
+    return object_id > 0u && object_id < uint(textureSize(selected)) && texelFetch(selected, int(object_id)).r != 0u;
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    ivec2 last = textureSize(object_ids, 0) - 1;
+    uint center = texelFetch(object_ids, pixel, 0).r;
+    if (is_selected(center))
+    {
+        discard;
+    }
+
+    // Outside a selected object, look for one within a disk around the pixel
+    for (int y = -RADIUS; y <= RADIUS; y++)
+    {
+        for (int x = -RADIUS; x <= RADIUS; x++)
+        {
+            if (x * x + y * y > RADIUS * RADIUS) continue;
+            uint neighbor = texelFetch(object_ids, clamp(pixel + ivec2(x, y), ivec2(0), last), 0).r;
+            if (is_selected(neighbor))
+            {
+                fragColor = vec4(color, 1.0);
+                return;
+            }
+        }
+    }
+    discard;
+}
@@ -1,6 +1,7 @@
 #version 330 core
 
-out vec4 fragColor;
+layout (location = 0) out vec4 fragColor;
+layout (location = 1) out uint fragObjectID; // read for picking when the main pass renders to Selection
 
 in vec3 vertex_texture;
 
@@ -9,4 +10,5 @@ uniform samplerCube cubemap;
 void main()
 {
     fragColor = texture(cubemap, normalize(vertex_texture));
+    fragObjectID = 0u;
 }
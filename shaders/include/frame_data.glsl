@@ -0,0 +1,24 @@
+struct LightSource
+{
+    vec4 color; // rgb
+    vec4 position; // xyz, in world space
+    vec4 direction; // xyz, in world space
+    float is_on;
+    float diffuse_intensity;
+    float specular_intensity;
+    float strength; // used for calculating attenuation
+};
+
+// Per-frame data shared by all programs, must match struct FrameData in frameuniforms.h
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 vp; // projection * view
+    vec4 camera_position; // xyz, in world space
+    LightSource light; // point light
+    LightSource sun;
+    LightSource flashlight;
+    float ambient_light_intensity;
+    uint hovered_object_id; // 0 if none
+};
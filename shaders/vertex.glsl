@@ -3,23 +3,36 @@
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 normal;
 layout (location = 2) in vec2 texcoord;
+layout (location = 3) in mat4 instance_m; // locations 3-6, per instance
+layout (location = 7) in mat3 instance_m_for_normals; // locations 7-9, per instance
+layout (location = 10) in uint instance_object_id; // per instance
 
-uniform mat4 m, mvp;
+#include "include/frame_data.glsl"
+
+uniform mat4 m;
 uniform mat3 m_for_normals;
+uniform uint object_id; // 0 for objects that cannot be selected
+uniform bool instanced; // read model matrices and ID from instance attributes instead of uniforms
 
 out vec2 vertex_texture;
 out vec3 vertex_normal; // in world space
 out vec3 vertex_position; // in world space
+flat out uint vertex_object_id;
 
 void main()
 {
     // Calculate vertex position in clip space
-    gl_Position = mvp * vec4(position, 1.0);
+    mat4 model = instanced ? instance_m : m;
+    mat3 model_for_normals = instanced ? instance_m_for_normals : m_for_normals;
+    vec4 world_position = model * vec4(position, 1.0);
+    gl_Position = vp * world_position;
 
     // Calculate data to be interpolated and used in fragment shader
     // For texturing
     vertex_texture = texcoord;
     // For lighting (in world space)
-    vertex_normal = normalize(m_for_normals * normal);
-    vertex_position = (m * vec4(position, 1.0)).xyz;
+    vertex_normal = normalize(model_for_normals * normal);
+    vertex_position = world_position.xyz;
+    // For picking
+    vertex_object_id = instanced ? instance_object_id : object_id;
 }
\ No newline at end of file
@@ -0,0 +1,19 @@
+#version 330 core
+
+layout (location = 0) in vec2 position; // in pixels, origin at top left
+layout (location = 1) in vec2 texel; // in the font texture, corners of texels
+layout (location = 2) in vec4 color;
+
+uniform float screen_width, screen_height;
+uniform sampler2D font;
+
+out vec2 texture_coord;
+out vec4 vertex_color;
+
+void main()
+{
+    gl_Position = vec4(position / vec2(screen_width, screen_height) * 2.0 - 1.0, 0.0, 1.0);
+    gl_Position.y = -gl_Position.y;
+    texture_coord = texel / vec2(textureSize(font, 0));
+    vertex_color = color;
+}
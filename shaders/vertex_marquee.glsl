@@ -0,0 +1,26 @@
+#version 330 core
+
+uniform usampler2D object_ids; // written by the main pass, 0 where there is no object
+uniform int rect_x, rect_y, rect_width; // rectangle being reduced, in pixels
+uniform int bitmap_width, bitmap_height; // in 32-bit words
+
+flat out uint bit;
+
+void main()
+{
+    // One point per pixel of the rectangle, row by row
+    ivec2 pixel = ivec2(rect_x + gl_VertexID % rect_width, rect_y + gl_VertexID / rect_width);
+    uint object_id = texelFetch(object_ids, pixel, 0).r;
+
+    // The point lands on the word holding the object's bit
+    int word = int(object_id >> 5u);
+    ivec2 texel = ivec2(word % bitmap_width, word / bitmap_width);
+    bit = 1u << (object_id & 31u);
+    gl_Position = vec4((vec2(texel) + 0.5) / vec2(bitmap_width, bitmap_height) * 2.0 - 1.0, 0.0, 1.0);
+
+    // No object, or one beyond the bitmap, is moved outside the clip volume and dropped
+    if (object_id == 0u || texel.y >= bitmap_height)
+    {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+    }
+}
@@ -0,0 +1,151 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <glad/gl.h>
+#include "benchmark.h"
+#include "framestats.h"
+
+Benchmark::Benchmark(const std::string &path_filepath, const std::vector<std::string> &render_mode_names, bool &success) :
+    path_filepath(path_filepath), path(path_filepath, success), render_mode_names(render_mode_names),
+    mode(0), frame(0), warmup_frames_left(WARMUP_FRAMES), measuring(false), results(render_mode_names.size())
+{
+    // Left empty intentionally
+}
+
+bool Benchmark::begin_frame(bool programs_ready, glm::vec3 &position, float &yaw, float &pitch, uint &render_mode)
+{
+    if (mode == render_mode_names.size())
+    {
+        return false;
+    }
+    render_mode = mode;
+
+    // Hold the camera at the start of the path until warmed up
+    measuring = programs_ready && warmup_frames_left == 0;
+    if (programs_ready && warmup_frames_left > 0)
+    {
+        warmup_frames_left--;
+    }
+    path.sample(measuring ? frame * FRAME_TIME : 0.f, position, yaw, pitch);
+    frame_start = std::chrono::steady_clock::now();
+    return true;
+}
+
+void Benchmark::end_frame()
+{
+    glFinish();
+    if (!measuring)
+    {
+        return;
+    }
+    std::chrono::duration<float, std::milli> frame_time = std::chrono::steady_clock::now() - frame_start;
+    ModeResults &r = results[mode];
+    r.frame_ms.push_back(frame_time.count());
+    r.draw_calls += frame_stats.gl.draw_calls;
+    r.models_visible += frame_stats.models_visible;
+    r.gl_calls_issued += frame_stats.gl_calls_issued;
+
+    // Move on to the next render mode at the end of the path
+    frame++;
+    if (frame * FRAME_TIME > path.duration())
+    {
+        std::cout << "Benchmark: " << render_mode_names[mode] << " done, " << frame << " frames" << std::endl;
+        mode++;
+        frame = 0;
+        warmup_frames_left = WARMUP_FRAMES;
+    }
+}
+
+// Write text as a quoted JSON string, escaping quotes, backslashes and control characters
+void write_json_string(std::ofstream &out, const std::string &text)
+{
+    out << '"';
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out << '\\' << c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            out << escaped;
+        }
+        else
+        {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+// Write "frame_ms": {...} with the mean and nearest-rank percentiles of frame times
+void write_frame_times(std::ofstream &out, std::vector<float> frame_ms)
+{
+    if (frame_ms.empty())
+    {
+        out << "\"frame_ms\": null";
+        return;
+    }
+    std::sort(frame_ms.begin(), frame_ms.end());
+    auto percentile = [&frame_ms](float p) {
+        size_t rank = std::max<size_t>(1, static_cast<size_t>(std::ceil(p / 100.f * frame_ms.size())));
+        return frame_ms[rank - 1];
+    };
+    float sum = 0.f;
+    for (float ms : frame_ms) sum += ms;
+    out << "\"frame_ms\": {\"mean\": " << sum / frame_ms.size() << ", \"p50\": " << percentile(50.f);
+    out << ", \"p95\": " << percentile(95.f) << ", \"p99\": " << percentile(99.f);
+    out << ", \"max\": " << frame_ms.back() << "}";
+}
+
+bool Benchmark::write_report(const std::string &filepath) const
+{
+    std::ofstream out(filepath, std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "Error: cannot write benchmark report " << filepath << std::endl;
+        return false;
+    }
+
+    // Render mode names are fixed identifiers, the path and renderer come from outside and are escaped
+    std::vector<float> all_frame_ms;
+    const char *renderer = reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+    out << "{" << std::endl;
+    out << "  \"camera_path\": ";
+    write_json_string(out, path_filepath);
+    out << "," << std::endl;
+    out << "  \"renderer\": ";
+    write_json_string(out, renderer ? renderer : "");
+    out << "," << std::endl;
+    out << "  \"frame_time_step_s\": " << FRAME_TIME << "," << std::endl;
+    out << "  \"render_modes\": [" << std::endl;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const ModeResults &r = results[i];
+        float frames = std::max<size_t>(1, r.frame_ms.size());
+        out << "    {\"name\": \"" << render_mode_names[i] << "\", \"frames\": " << r.frame_ms.size() << ", ";
+        write_frame_times(out, r.frame_ms);
+        out << ", \"draw_calls_per_frame\": " << r.draw_calls / frames;
+        out << ", \"models_visible_per_frame\": " << r.models_visible / frames;
+        out << ", \"gl_state_calls_per_frame\": " << r.gl_calls_issued / frames;
+        out << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+        all_frame_ms.insert(all_frame_ms.end(), r.frame_ms.begin(), r.frame_ms.end());
+    }
+    out << "  ]," << std::endl;
+    out << "  \"overall\": {\"frames\": " << all_frame_ms.size() << ", ";
+    write_frame_times(out, all_frame_ms);
+    out << "}" << std::endl;
+    out << "}" << std::endl;
+    out.close();
+    if (!out)
+    {
+        std::cout << "Error: failed writing benchmark report " << filepath << std::endl;
+        return false;
+    }
+    std::cout << "Benchmark report written to " << filepath << std::endl;
+    return true;
+}
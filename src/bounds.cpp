@@ -0,0 +1,22 @@
+#include <algorithm>
+#include "bounds.h"
+
+Bounds merge_bounds(const Bounds &a, const Bounds &b)
+{
+    Bounds merged;
+    merged.min = glm::min(a.min, b.min);
+    merged.max = glm::max(a.max, b.max);
+    merged.center = (merged.min + merged.max) * .5f;
+    merged.radius = std::max(glm::length(a.center - merged.center) + a.radius,
+                             glm::length(b.center - merged.center) + b.radius);
+    return merged;
+}
+
+void transform_sphere(const Bounds &bounds, const glm::mat4 &transform, glm::vec3 &center, float &radius)
+{
+    center = glm::vec3(transform * glm::vec4(bounds.center, 1.f));
+    float scale_x = glm::length(glm::vec3(transform[0]));
+    float scale_y = glm::length(glm::vec3(transform[1]));
+    float scale_z = glm::length(glm::vec3(transform[2]));
+    radius = bounds.radius * std::max(scale_x, std::max(scale_y, scale_z));
+}
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "bvh.h"
+
+// Primitives per leaf, at most
+const uint MAX_LEAF_SIZE = 4;
+
+Box Box::empty()
+{
+    float inf = std::numeric_limits<float>::infinity();
+    return Box{glm::vec3(inf), glm::vec3(-inf)};
+}
+
+void Box::grow(const glm::vec3 &point)
+{
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+void Box::grow(const Box &box)
+{
+    min = glm::min(min, box.min);
+    max = glm::max(max, box.max);
+}
+
+glm::vec3 Box::center() const
+{
+    return (min + max) * .5f;
+}
+
+Box Box::transformed(const glm::mat4 &transform) const
+{
+    Box result = empty();
+    for (uint corner = 0; corner < 8; corner++)
+    {
+        glm::vec3 point((corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z);
+        result.grow(glm::vec3(transform * glm::vec4(point, 1.f)));
+    }
+    return result;
+}
+
+bool Box::intersect(const glm::vec3 &origin, const glm::vec3 &inverse_direction, float max_distance, float &distance) const
+{
+    // Slab test, infinities from axis-parallel rays compare correctly
+    glm::vec3 t0 = (min - origin) * inverse_direction;
+    glm::vec3 t1 = (max - origin) * inverse_direction;
+    glm::vec3 t_near = glm::min(t0, t1);
+    glm::vec3 t_far = glm::max(t0, t1);
+    float enter = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, 0.f));
+    float exit = std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, max_distance));
+    distance = enter;
+    return enter <= exit;
+}
+
+// Build nodes over primitives with the given boxes, by splitting at the median centroid along the widest axis.
+// order receives the primitive indices in leaf order.
+void build_nodes(const std::vector<Box> &boxes, std::vector<BVHNode> &nodes, std::vector<uint> &order)
+{
+    nodes.clear();
+    order.resize(boxes.size());
+    for (size_t i = 0; i < boxes.size(); i++) order[i] = i;
+    if (boxes.empty()) return;
+    nodes.reserve(2 * boxes.size());
+    nodes.push_back(BVHNode{Box::empty(), 0, static_cast<uint>(boxes.size())});
+
+    // Nodes still to split, as indices into nodes
+    std::vector<uint> to_split = {0};
+    while (!to_split.empty())
+    {
+        uint index = to_split.back();
+        to_split.pop_back();
+        uint first = nodes[index].first;
+        uint count = nodes[index].count;
+
+        Box box = Box::empty();
+        Box centroids = Box::empty();
+        for (uint i = first; i < first + count; i++)
+        {
+            box.grow(boxes[order[i]]);
+            centroids.grow(boxes[order[i]].center());
+        }
+        nodes[index].box = box;
+        if (count <= MAX_LEAF_SIZE) continue;
+
+        glm::vec3 extent = centroids.max - centroids.min;
+        int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+        uint half = count / 2;
+        std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+            [&](uint a, uint b) { return boxes[a].center()[axis] < boxes[b].center()[axis]; });
+
+        // Turn the node into an inner node with two consecutive children
+        uint children = nodes.size();
+        nodes.push_back(BVHNode{Box::empty(), first, half});
+        nodes.push_back(BVHNode{Box::empty(), first + half, count - half});
+        nodes[index].first = children;
+        nodes[index].count = 0;
+        to_split.push_back(children);
+        to_split.push_back(children + 1);
+    }
+}
+
+TriangleBVH::TriangleBVH(const std::vector<glm::vec3> &triangle_vertices)
+{
+    size_t num = triangle_vertices.size() / 3;
+    std::vector<Box> boxes(num, Box::empty());
+    for (size_t i = 0; i < num; i++)
+    {
+        for (size_t v = 0; v < 3; v++) boxes[i].grow(triangle_vertices[3 * i + v]);
+    }
+    build_nodes(boxes, nodes, triangle_ids);
+
+    // Store triangles in leaf order, so that a leaf reads contiguous memory
+    vertices.resize(3 * num);
+    for (size_t i = 0; i < num; i++)
+    {
+        for (size_t v = 0; v < 3; v++) vertices[3 * i + v] = triangle_vertices[3 * triangle_ids[i] + v];
+    }
+}
+
+// Möller-Trumbore ray-triangle intersection
+bool intersect_triangle(const Ray &ray, const glm::vec3 *triangle, float &distance)
+{
+    const float EPSILON = 1e-7f;
+    glm::vec3 edge1 = triangle[1] - triangle[0];
+    glm::vec3 edge2 = triangle[2] - triangle[0];
+    glm::vec3 p = glm::cross(ray.direction, edge2);
+    float determinant = glm::dot(edge1, p);
+    if (std::abs(determinant) < EPSILON) return false; // parallel
+    float inverse_determinant = 1.f / determinant;
+    glm::vec3 s = ray.origin - triangle[0];
+    float u = glm::dot(s, p) * inverse_determinant;
+    if (u < 0.f || u > 1.f) return false;
+    glm::vec3 q = glm::cross(s, edge1);
+    float v = glm::dot(ray.direction, q) * inverse_determinant;
+    if (v < 0.f || u + v > 1.f) return false;
+    distance = glm::dot(edge2, q) * inverse_determinant;
+    return distance > 0.f;
+}
+
+bool TriangleBVH::intersect(const Ray &ray, float max_distance, uint &triangle, float &distance) const
+{
+    if (nodes.empty()) return false;
+    bool hit = false;
+    glm::vec3 inverse_direction = 1.f / ray.direction;
+    uint stack[BVH_STACK_SIZE];
+    uint stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        const BVHNode &node = nodes[stack[--stack_size]];
+        float entry;
+        if (!node.box.intersect(ray.origin, inverse_direction, max_distance, entry)) continue;
+        if (node.count > 0)
+        {
+            for (uint i = node.first; i < node.first + node.count; i++)
+            {
+                float t;
+                if (intersect_triangle(ray, &vertices[3 * i], t) && t < max_distance)
+                {
+                    max_distance = t;
+                    triangle = triangle_ids[i];
+                    distance = t;
+                    hit = true;
+                }
+            }
+            continue;
+        }
+
+        // Visit the nearer child first (it is pushed last), so that far subtrees get pruned
+        float entry_first, entry_second;
+        bool hit_first = nodes[node.first].box.intersect(ray.origin, inverse_direction, max_distance, entry_first);
+        bool hit_second = nodes[node.first + 1].box.intersect(ray.origin, inverse_direction, max_distance, entry_second);
+        if (hit_first && hit_second)
+        {
+            bool first_nearer = entry_first <= entry_second;
+            stack[stack_size++] = first_nearer ? node.first + 1 : node.first;
+            stack[stack_size++] = first_nearer ? node.first : node.first + 1;
+        }
+        else if (hit_first)
+        {
+            stack[stack_size++] = node.first;
+        }
+        else if (hit_second)
+        {
+            stack[stack_size++] = node.first + 1;
+        }
+    }
+    return hit;
+}
+
+Box TriangleBVH::bounds() const
+{
+    return nodes.empty() ? Box{glm::vec3(0.f), glm::vec3(0.f)} : nodes[0].box;
+}
+
+size_t TriangleBVH::num_triangles() const
+{
+    return triangle_ids.size();
+}
+
+void SceneBVH::build(const std::vector<Box> &boxes)
+{
+    build_nodes(boxes, nodes, objects);
+}
+
+void SceneBVH::refit(const std::vector<Box> &boxes)
+{
+    // Children always come after their parent, so walking backwards visits them first
+    for (size_t i = nodes.size(); i-- > 0;)
+    {
+        BVHNode &node = nodes[i];
+        Box box = Box::empty();
+        if (node.count > 0)
+        {
+            for (uint j = node.first; j < node.first + node.count; j++) box.grow(boxes[objects[j]]);
+        }
+        else
+        {
+            box.grow(nodes[node.first].box);
+            box.grow(nodes[node.first + 1].box);
+        }
+        node.box = box;
+    }
+}
@@ -33,13 +33,20 @@ float mouse_sensitivity = .008f;
 float zoom = 1;
 float scroll_sensitivity = 0.1f;
 
+bool mode_stats = false;
 bool mode_selection = false;
+bool mode_hud = false;
 bool mouse_clicked = false;
 uint click_x = 0;
 uint click_y = 0;
+bool marquee_dragging = false;
+bool marquee_requested = false;
+bool trace_requested = false;
+double marquee_x0 = 0, marquee_y0 = 0, marquee_x1 = 0, marquee_y1 = 0;
 
 // From main.cpp
 extern Zm render_mode;
+extern Zm picking_mode;
 extern std::unique_ptr<Zm> cur_skybox;
 
 void key_callback(GLFWwindow *window, int key, [[maybe_unused]] int scancode, [[maybe_unused]] int action, [[maybe_unused]] int mods)
@@ -84,6 +91,36 @@ void key_callback(GLFWwindow *window, int key, [[maybe_unused]] int scancode, [[
         cursor_mode = mode_selection ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED;
         glfwSetInputMode(window, GLFW_CURSOR, cursor_mode);
         break;
+    case GLFW_KEY_6:
+        // Toggle printing of frame statistics
+        if (action == GLFW_PRESS)
+        {
+            mode_stats = !mode_stats;
+        }
+        break;
+    case GLFW_KEY_7:
+        // Cycle through picking methods, to compare frame times
+        if (action == GLFW_PRESS)
+        {
+            const char *PICKING_MODES[] = {"object IDs in main pass", "separate object ID pass", "CPU ray cast"};
+            picking_mode.inc();
+            std::cout << "Picking: " << PICKING_MODES[picking_mode.value] << std::endl;
+        }
+        break;
+    case GLFW_KEY_8:
+        // Export a profiler trace of the latest frames
+        if (action == GLFW_PRESS)
+        {
+            trace_requested = true;
+        }
+        break;
+    case GLFW_KEY_9:
+        // Toggle the performance overlay
+        if (action == GLFW_PRESS)
+        {
+            mode_hud = !mode_hud;
+        }
+        break;
     case GLFW_KEY_W:
         modify_by_action(action, 1, move_y);
         break;
@@ -154,16 +191,34 @@ void mouse_callback([[maybe_unused]] GLFWwindow *window, double x, double y)
     last_mouse_y = y;
 }
 
-void mouse_click_callback(GLFWwindow *window, int button, int action, [[maybe_unused]] int mods)
+void mouse_click_callback(GLFWwindow *window, int button, int action, int mods)
 {
     double x, y;
-    if (mode_selection && button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+    if (!mode_selection || button != GLFW_MOUSE_BUTTON_LEFT)
+    {
+        return;
+    }
+    glfwGetCursorPos(window, &x, &y);
+    if (action == GLFW_PRESS && (mods & GLFW_MOD_SHIFT))
+    {
+        // Shift+drag selects everything inside the rectangle
+        marquee_dragging = true;
+        marquee_x0 = x;
+        marquee_y0 = y;
+    }
+    else if (action == GLFW_PRESS)
     {
-        glfwGetCursorPos(window, &x, &y);
         mouse_clicked = true;
         click_x = static_cast<uint>(x);
         click_y = static_cast<uint>(y);
     }
+    else if (action == GLFW_RELEASE && marquee_dragging)
+    {
+        marquee_dragging = false;
+        marquee_requested = true;
+        marquee_x1 = x;
+        marquee_y1 = y;
+    }
 }
 
 void scroll_callback([[maybe_unused]] GLFWwindow *window, [[maybe_unused]] double xoffset, double yoffset)
@@ -52,4 +52,15 @@ glm::mat4 Camera::get_view() const
 glm::mat4 Camera::get_projection() const
 {
     return projection;
-}
\ No newline at end of file
+}
+
+Ray Camera::ray_through(float ndc_x, float ndc_y) const
+{
+    // Unproject points on the near and far planes
+    glm::mat4 inverse_vp = glm::inverse(projection * view);
+    glm::vec4 near_point = inverse_vp * glm::vec4(ndc_x, ndc_y, -1.f, 1.f);
+    glm::vec4 far_point = inverse_vp * glm::vec4(ndc_x, ndc_y, 1.f, 1.f);
+    glm::vec3 origin = glm::vec3(near_point) / near_point.w;
+    glm::vec3 target = glm::vec3(far_point) / far_point.w;
+    return Ray{origin, glm::normalize(target - origin)};
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <glm/glm.hpp>
+#include "camerapath.h"
+
+CameraPath::CameraPath(const std::string &filepath, bool &success)
+{
+    success = false;
+    std::ifstream file(filepath);
+    if (!file)
+    {
+        std::cout << "Cannot find camera path file: " << filepath << std::endl;
+        return;
+    }
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        line_number++;
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        Keyframe k;
+        if (!(fields >> k.time >> k.position.x >> k.position.y >> k.position.z >> k.yaw >> k.pitch) ||
+            (!keyframes.empty() && k.time <= keyframes.back().time))
+        {
+            std::cout << "Error: bad keyframe in " << filepath << ":" << line_number << std::endl;
+            return;
+        }
+        keyframes.push_back(k);
+    }
+    if (keyframes.empty())
+    {
+        std::cout << "Error: no keyframes in " << filepath << std::endl;
+        return;
+    }
+    success = true;
+}
+
+void CameraPath::sample(float time, glm::vec3 &position, float &yaw, float &pitch) const
+{
+    // Find the keyframes around the time, paths are short so a linear search will do
+    size_t next = 0;
+    while (next < keyframes.size() && keyframes[next].time <= time)
+    {
+        next++;
+    }
+    if (next == 0 || next == keyframes.size())
+    {
+        const Keyframe &k = next == 0 ? keyframes.front() : keyframes.back();
+        position = k.position;
+        yaw = k.yaw;
+        pitch = k.pitch;
+        return;
+    }
+
+    const Keyframe &a = keyframes[next - 1];
+    const Keyframe &b = keyframes[next];
+    float t = (time - a.time) / (b.time - a.time);
+    position = glm::mix(a.position, b.position, t);
+    yaw = glm::mix(a.yaw, b.yaw, t);
+    pitch = glm::mix(a.pitch, b.pitch, t);
+}
+
+float CameraPath::duration() const
+{
+    return keyframes.back().time;
+}
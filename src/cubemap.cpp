@@ -2,73 +2,75 @@
 #include <vector>
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
-#include "stb_image.h"
 #include "cubemap.h"
+#include "glstate.h"
+#include "profiler.h"
+#include "framestats.h"
 
+std::vector<std::unique_ptr<Image>> read_faces(const std::string &texture_directory)
+{
+    PROFILE_ZONE("read cube map faces");
+    std::vector<std::unique_ptr<Image>> faces;
+    for (const std::string &path : CubeMap::face_paths(texture_directory))
+    {
+        faces.emplace_back(std::make_unique<Image>(path));
+    }
+    return faces;
+}
 
-CubeMap::CubeMap(std::string texture_directory)
+CubeMap::CubeMap(std::string texture_directory) : CubeMap(read_faces(texture_directory))
 {
+    // Left empty intentionally
+}
+
+CubeMap::CubeMap(const std::vector<std::unique_ptr<Image>> &faces) : gpu_bytes(0)
+{
+    PROFILE_ZONE("CubeMap::CubeMap");
+
     // Prepare OpenGL texture
     glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, id);
+    state_bind_texture(0, GL_TEXTURE_CUBE_MAP, id);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     
-    // Prepare individual texture paths
-    std::vector<std::string> paths = {"/right.jpg", "/left.jpg", "/top.jpg", "/bottom.jpg", "/front.jpg", "/back.jpg"};
-
-    // Read image files
-    int texwidth, texheight, texchannels;
-    stbi_set_flip_vertically_on_load(false);
-    unsigned char *texdata; 
-    for (size_t i = 0; i < paths.size(); i++)
+    // Copy faces into GPU
+    for (size_t i = 0; i < faces.size(); i++)
     {
-        std::string cur_path = texture_directory + paths[i];
-        texdata = stbi_load(cur_path.c_str(), &texwidth, &texheight, &texchannels, 0);
-
-        // Infere RGB or RGBA from number of channels
-        GLenum format = GL_RGB;
-        switch (texchannels)
+        const Image &face = *faces[i];
+        if (face.is_valid())
         {
-        case 3:
-            // Keep it GL_RGB
-            break;
-        case 4:
-            format = GL_RGBA;
-            break;
-        default:
-            std::cout << "Error: unsupported number of channels " << texchannels;
-            std::cout << " in texture " << cur_path << std::endl;
-            break;
-        }
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, face.width, face.height, 0, face.gl_format(), GL_UNSIGNED_BYTE, face.pixels);
 
-        // Copy image into GPU
-        if (texdata)
-        {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, texwidth, texheight, 0, format, GL_UNSIGNED_BYTE, texdata);
-        }
-        else
-        {
-            std::cout << "Failed to load texture" << std::endl;
-            std::cout << cur_path << std::endl;
+            // Drivers pad RGB texels to 4 bytes
+            gpu_bytes += (size_t)face.width * face.height * 4;
         }
-        
-        stbi_image_free(texdata);
     }
+    track_gpu_memory(GPU_MEMORY_CUBE_MAPS, gpu_bytes);
 }
 
 CubeMap::~CubeMap()
 {
     std::cout << "NOTE: deleting cubemap " << id << std::endl;
+    track_gpu_memory(GPU_MEMORY_CUBE_MAPS, -(int64_t)gpu_bytes);
+    state_forget_texture(id);
     glDeleteTextures(1, &id);
 }
 
 
 void CubeMap::activate(uint unit) const
 {
-    glActiveTexture(GL_TEXTURE0 + unit);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, id);
-}
\ No newline at end of file
+    state_bind_texture(unit, GL_TEXTURE_CUBE_MAP, id);
+}
+
+std::vector<std::string> CubeMap::face_paths(const std::string &texture_directory)
+{
+    std::vector<std::string> paths = {"/right.jpg", "/left.jpg", "/top.jpg", "/bottom.jpg", "/front.jpg", "/back.jpg"};
+    for (std::string &path : paths)
+    {
+        path = texture_directory + path;
+    }
+    return paths;
+}
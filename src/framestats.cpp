@@ -0,0 +1,251 @@
+#include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include "shaders.h"
+#include "framestats.h"
+#include "profiler.h"
+
+// From callbacks.cpp
+extern bool mode_stats;
+
+FrameStats frame_stats;
+
+// Totals over the current reporting period
+FrameStats period_stats;
+uint period_frames = 0;
+float period_time = 0.f;
+
+// Passes of the current frame, and their totals over the reporting period
+PassStats passes[MAX_STATS_PASSES];
+uint num_passes = 0;
+PassStats period_passes[MAX_STATS_PASSES];
+uint num_period_passes = 0;
+
+// Live GPU memory, by kind
+int64_t gpu_memory_bytes[NUM_GPU_MEMORY_KINDS] = {};
+const char *GPU_MEMORY_NAMES[NUM_GPU_MEMORY_KINDS] = {"meshes", "textures", "cube maps", "skybox", "ground", "selection"};
+
+// Values at the start of the current frame
+uint64_t frame_start_allocations = 0;
+uint frame_start_location_queries = 0;
+
+// Count every heap allocation of the process.
+// This file replaces the global operator new and delete for the whole program, in their plain and
+// over-aligned forms. The array and nothrow forms call these by default, so they are counted too.
+// Like the standard ones, the replacements call the installed new_handler until memory is found
+// or there is no handler left, then throw std::bad_alloc.
+std::atomic<uint64_t> num_allocations(0);
+
+void *counted_allocate(size_t size, size_t alignment)
+{
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    size = size ? size : 1;
+    if (alignment > alignof(std::max_align_t))
+    {
+        // aligned_alloc needs a size that is a multiple of the alignment
+        size = (size + alignment - 1) / alignment * alignment;
+    }
+    while (true)
+    {
+        void *memory = alignment > alignof(std::max_align_t) ? std::aligned_alloc(alignment, size) : std::malloc(size);
+        if (memory) return memory;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void *operator new(size_t size)
+{
+    return counted_allocate(size, alignof(std::max_align_t));
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    return counted_allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, [[maybe_unused]] size_t size) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, [[maybe_unused]] std::align_val_t alignment) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, [[maybe_unused]] size_t size, [[maybe_unused]] std::align_val_t alignment) noexcept
+{
+    std::free(memory);
+}
+
+uint64_t allocation_count()
+{
+    return num_allocations.load(std::memory_order_relaxed);
+}
+
+GLCalls &operator+=(GLCalls &a, const GLCalls &b)
+{
+    a.draw_calls += b.draw_calls;
+    a.indices += b.indices;
+    a.program_binds += b.program_binds;
+    a.texture_binds += b.texture_binds;
+    a.uniform_uploads += b.uniform_uploads;
+    a.buffer_uploads += b.buffer_uploads;
+    a.buffer_upload_bytes += b.buffer_upload_bytes;
+    a.framebuffer_binds += b.framebuffer_binds;
+    return a;
+}
+
+GLCalls operator-(const GLCalls &a, const GLCalls &b)
+{
+    GLCalls d;
+    d.draw_calls = a.draw_calls - b.draw_calls;
+    d.indices = a.indices - b.indices;
+    d.program_binds = a.program_binds - b.program_binds;
+    d.texture_binds = a.texture_binds - b.texture_binds;
+    d.uniform_uploads = a.uniform_uploads - b.uniform_uploads;
+    d.buffer_uploads = a.buffer_uploads - b.buffer_uploads;
+    d.buffer_upload_bytes = a.buffer_upload_bytes - b.buffer_upload_bytes;
+    d.framebuffer_binds = a.framebuffer_binds - b.framebuffer_binds;
+    return d;
+}
+
+// Add to the pass of the given name in a list, if there is room for it
+void add_to_pass(PassStats *list, uint &num, const char *name, const GLCalls &gl, float cpu_ms)
+{
+    uint i = 0;
+    while (i < num && list[i].name != name) i++;
+    if (i == MAX_STATS_PASSES)
+    {
+        return;
+    }
+    if (i == num)
+    {
+        list[num++] = PassStats{name, GLCalls(), 0.f};
+    }
+    list[i].gl += gl;
+    list[i].cpu_ms += cpu_ms;
+}
+
+StatsPass::StatsPass(const char *name) : name(name), start(frame_stats.gl), start_ns(profiler_now())
+{
+    // Left empty intentionally
+}
+
+StatsPass::~StatsPass()
+{
+    add_to_pass(passes, num_passes, name, frame_stats.gl - start, (profiler_now() - start_ns) / 1e6f);
+}
+
+const PassStats *frame_passes(uint &num)
+{
+    num = num_passes;
+    return passes;
+}
+
+void track_gpu_memory(GpuMemoryKind kind, int64_t bytes)
+{
+    gpu_memory_bytes[kind] += bytes;
+}
+
+int64_t gpu_memory(GpuMemoryKind kind)
+{
+    return gpu_memory_bytes[kind];
+}
+
+// Print calls per frame, averaged over a number of frames
+void print_gl_calls(const GLCalls &gl, float frames)
+{
+    std::cout << gl.draw_calls / frames << " draws, " << gl.indices / frames << " indices, ";
+    std::cout << gl.program_binds / frames << " program binds, " << gl.texture_binds / frames << " texture binds, ";
+    std::cout << gl.uniform_uploads / frames << " uniform uploads, " << gl.buffer_uploads / frames << " buffer uploads (";
+    std::cout << gl.buffer_upload_bytes / frames / 1024 << "KB), " << gl.framebuffer_binds / frames << " framebuffer binds";
+}
+
+void begin_frame_stats()
+{
+    frame_stats = FrameStats();
+    num_passes = 0;
+    frame_start_allocations = allocation_count();
+    frame_start_location_queries = Shaders::location_queries;
+}
+
+void end_frame_stats(float delta_time)
+{
+    frame_stats.allocations = allocation_count() - frame_start_allocations;
+    frame_stats.uniform_location_queries = Shaders::location_queries - frame_start_location_queries;
+
+    // Accumulate
+    period_stats.allocations += frame_stats.allocations;
+    period_stats.gl += frame_stats.gl;
+    for (uint i = 0; i < num_passes; i++)
+    {
+        add_to_pass(period_passes, num_period_passes, passes[i].name, passes[i].gl, passes[i].cpu_ms);
+    }
+    period_stats.uniform_location_queries += frame_stats.uniform_location_queries;
+    period_stats.models_visible += frame_stats.models_visible;
+    period_stats.models_culled += frame_stats.models_culled;
+    period_stats.meshes_culled += frame_stats.meshes_culled;
+    period_stats.program_binds_avoided += frame_stats.program_binds_avoided;
+    period_stats.texture_binds_avoided += frame_stats.texture_binds_avoided;
+    period_stats.vertex_array_binds_avoided += frame_stats.vertex_array_binds_avoided;
+    period_stats.gl_calls_issued += frame_stats.gl_calls_issued;
+    period_stats.gl_calls_elided += frame_stats.gl_calls_elided;
+    period_frames++;
+    period_time += delta_time;
+    if (period_time < 1.f)
+    {
+        return;
+    }
+
+    // Report averages per frame
+    if (mode_stats)
+    {
+        float frames = period_frames;
+        std::cout << "[stats] " << frames / period_time << " fps, ";
+        std::cout << period_stats.allocations / frames << " allocations/frame, ";
+        std::cout << period_stats.uniform_location_queries / frames << " uniform location queries/frame, ";
+        std::cout << period_stats.models_visible / frames << " models visible, ";
+        std::cout << period_stats.models_culled / frames << " models culled, ";
+        std::cout << period_stats.meshes_culled / frames << " meshes culled/frame, ";
+        std::cout << "binds avoided/frame: " << period_stats.program_binds_avoided / frames << " program, ";
+        std::cout << period_stats.texture_binds_avoided / frames << " texture, ";
+        std::cout << period_stats.vertex_array_binds_avoided / frames << " vertex array, ";
+        std::cout << "GL state calls/frame: " << period_stats.gl_calls_issued / frames << " issued, ";
+        std::cout << period_stats.gl_calls_elided / frames << " elided" << std::endl;
+
+        // GL calls of the whole frame, then by pass
+        std::cout << "[stats] GL calls/frame: ";
+        print_gl_calls(period_stats.gl, frames);
+        std::cout << std::endl;
+        for (uint i = 0; i < num_period_passes; i++)
+        {
+            std::cout << "[stats]   " << period_passes[i].name << ": " << period_passes[i].cpu_ms / frames << "ms CPU, ";
+            print_gl_calls(period_passes[i].gl, frames);
+            std::cout << std::endl;
+        }
+
+        // Live totals, not averages
+        std::cout << "[stats] GPU memory: ";
+        int64_t total_bytes = 0;
+        for (uint kind = 0; kind < NUM_GPU_MEMORY_KINDS; kind++)
+        {
+            std::cout << GPU_MEMORY_NAMES[kind] << " " << gpu_memory_bytes[kind] / 1024 << "KB, ";
+            total_bytes += gpu_memory_bytes[kind];
+        }
+        std::cout << "total " << total_bytes / (1024 * 1024) << "MB" << std::endl;
+    }
+    period_stats = FrameStats();
+    num_period_passes = 0;
+    period_frames = 0;
+    period_time = 0.f;
+}
@@ -0,0 +1,31 @@
+#include <iostream>
+#include <cstddef> // for offsetof
+#include <glad/gl.h>
+#include "frameuniforms.h"
+
+// Offsets dictated by std140, must match the FrameData block in the shaders
+static_assert(sizeof(LightData) == 64, "LightData does not match std140 layout");
+static_assert(offsetof(FrameData, camera_position) == 192, "FrameData does not match std140 layout");
+static_assert(offsetof(FrameData, light) == 208, "FrameData does not match std140 layout");
+static_assert(offsetof(FrameData, ambient_light_intensity) == 400, "FrameData does not match std140 layout");
+static_assert(offsetof(FrameData, hovered_object_id) == 404, "FrameData does not match std140 layout");
+
+FrameUniforms::FrameUniforms() : data()
+{
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, ubo);
+}
+
+FrameUniforms::~FrameUniforms()
+{
+    std::cout << "NOTE: deleting frame uniform buffer " << ubo << std::endl;
+    glDeleteBuffers(1, &ubo);
+}
+
+void FrameUniforms::upload() const
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+}
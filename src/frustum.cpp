@@ -0,0 +1,93 @@
+#include "frustum.h"
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+void PackedSpheres::clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+}
+
+void PackedSpheres::add(glm::vec3 center, float r)
+{
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    radius.push_back(r);
+}
+
+size_t PackedSpheres::size() const
+{
+    return x.size();
+}
+
+void Frustum::update(const glm::mat4 &vp)
+{
+    // Gribb-Hartmann: each plane is the fourth row of vp plus or minus one of the others
+    glm::mat4 rows = glm::transpose(vp);
+    planes[0] = rows[3] + rows[0]; // left
+    planes[1] = rows[3] - rows[0]; // right
+    planes[2] = rows[3] + rows[1]; // bottom
+    planes[3] = rows[3] - rows[1]; // top
+    planes[4] = rows[3] + rows[2]; // near
+    planes[5] = rows[3] - rows[2]; // far
+
+    // Normalize so that plane equations give true distances
+    for (glm::vec4 &plane : planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+bool Frustum::intersects(glm::vec3 center, float radius) const
+{
+    for (const glm::vec4 &plane : planes)
+    {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Frustum::cull(const PackedSpheres &spheres, std::vector<uint8_t> &visible) const
+{
+    size_t num = spheres.size();
+    visible.resize(num);
+    size_t i = 0;
+
+#if defined(__SSE__)
+    // Four spheres against one plane at a time
+    for (; i + 4 <= num; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(&spheres.x[i]);
+        __m128 y = _mm_loadu_ps(&spheres.y[i]);
+        __m128 z = _mm_loadu_ps(&spheres.z[i]);
+        __m128 neg_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+        __m128 inside = _mm_cmpeq_ps(x, x); // all ones, unless x is NaN
+        for (const glm::vec4 &plane : planes)
+        {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+                _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, neg_radius));
+        }
+        int mask = _mm_movemask_ps(inside);
+        visible[i] = mask & 1;
+        visible[i + 1] = (mask >> 1) & 1;
+        visible[i + 2] = (mask >> 2) & 1;
+        visible[i + 3] = (mask >> 3) & 1;
+    }
+#endif
+
+    // Remaining spheres one by one
+    for (; i < num; i++)
+    {
+        glm::vec3 center(spheres.x[i], spheres.y[i], spheres.z[i]);
+        visible[i] = intersects(center, spheres.radius[i]);
+    }
+}
@@ -0,0 +1,150 @@
+#include <glad/gl.h>
+#include "glcounters.h"
+#include "framestats.h"
+
+// Entry points as loaded by glad, called by the wrappers below
+PFNGLDRAWARRAYSPROC real_draw_arrays;
+PFNGLDRAWELEMENTSPROC real_draw_elements;
+PFNGLDRAWELEMENTSINSTANCEDPROC real_draw_elements_instanced;
+PFNGLUSEPROGRAMPROC real_use_program;
+PFNGLBINDTEXTUREPROC real_bind_texture;
+PFNGLUNIFORM1IPROC real_uniform_1i;
+PFNGLUNIFORM1UIPROC real_uniform_1ui;
+PFNGLUNIFORM1FPROC real_uniform_1f;
+PFNGLUNIFORM3FPROC real_uniform_3f;
+PFNGLUNIFORM4FPROC real_uniform_4f;
+PFNGLUNIFORMMATRIX3FVPROC real_uniform_matrix_3fv;
+PFNGLUNIFORMMATRIX4FVPROC real_uniform_matrix_4fv;
+PFNGLBUFFERDATAPROC real_buffer_data;
+PFNGLBUFFERSUBDATAPROC real_buffer_sub_data;
+PFNGLBINDFRAMEBUFFERPROC real_bind_framebuffer;
+
+void GLAD_API_PTR count_draw_arrays(GLenum mode, GLint first, GLsizei count)
+{
+    frame_stats.gl.draw_calls++;
+    frame_stats.gl.indices += count;
+    real_draw_arrays(mode, first, count);
+}
+
+void GLAD_API_PTR count_draw_elements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+{
+    frame_stats.gl.draw_calls++;
+    frame_stats.gl.indices += count;
+    real_draw_elements(mode, count, type, indices);
+}
+
+void GLAD_API_PTR count_draw_elements_instanced(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                                GLsizei num_instances)
+{
+    frame_stats.gl.draw_calls++;
+    frame_stats.gl.indices += (uint64_t)count * num_instances;
+    real_draw_elements_instanced(mode, count, type, indices, num_instances);
+}
+
+void GLAD_API_PTR count_use_program(GLuint program)
+{
+    frame_stats.gl.program_binds++;
+    real_use_program(program);
+}
+
+void GLAD_API_PTR count_bind_texture(GLenum target, GLuint texture)
+{
+    frame_stats.gl.texture_binds++;
+    real_bind_texture(target, texture);
+}
+
+void GLAD_API_PTR count_uniform_1i(GLint location, GLint v0)
+{
+    frame_stats.gl.uniform_uploads++;
+    real_uniform_1i(location, v0);
+}
+
+void GLAD_API_PTR count_uniform_1ui(GLint location, GLuint v0)
+{
+    frame_stats.gl.uniform_uploads++;
+    real_uniform_1ui(location, v0);
+}
+
+void GLAD_API_PTR count_uniform_1f(GLint location, GLfloat v0)
+{
+    frame_stats.gl.uniform_uploads++;
+    real_uniform_1f(location, v0);
+}
+
+void GLAD_API_PTR count_uniform_3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+    frame_stats.gl.uniform_uploads++;
+    real_uniform_3f(location, v0, v1, v2);
+}
+
+void GLAD_API_PTR count_uniform_4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+    frame_stats.gl.uniform_uploads++;
+    real_uniform_4f(location, v0, v1, v2, v3);
+}
+
+void GLAD_API_PTR count_uniform_matrix_3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+{
+    frame_stats.gl.uniform_uploads++;
+    real_uniform_matrix_3fv(location, count, transpose, value);
+}
+
+void GLAD_API_PTR count_uniform_matrix_4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+{
+    frame_stats.gl.uniform_uploads++;
+    real_uniform_matrix_4fv(location, count, transpose, value);
+}
+
+void GLAD_API_PTR count_buffer_data(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+    frame_stats.gl.buffer_uploads++;
+    frame_stats.gl.buffer_upload_bytes += size;
+    real_buffer_data(target, size, data, usage);
+}
+
+void GLAD_API_PTR count_buffer_sub_data(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+{
+    frame_stats.gl.buffer_uploads++;
+    frame_stats.gl.buffer_upload_bytes += size;
+    real_buffer_sub_data(target, offset, size, data);
+}
+
+void GLAD_API_PTR count_bind_framebuffer(GLenum target, GLuint framebuffer)
+{
+    frame_stats.gl.framebuffer_binds++;
+    real_bind_framebuffer(target, framebuffer);
+}
+
+void install_gl_counters()
+{
+    real_draw_arrays = glad_glDrawArrays;
+    glad_glDrawArrays = count_draw_arrays;
+    real_draw_elements = glad_glDrawElements;
+    glad_glDrawElements = count_draw_elements;
+    real_draw_elements_instanced = glad_glDrawElementsInstanced;
+    glad_glDrawElementsInstanced = count_draw_elements_instanced;
+    real_use_program = glad_glUseProgram;
+    glad_glUseProgram = count_use_program;
+    real_bind_texture = glad_glBindTexture;
+    glad_glBindTexture = count_bind_texture;
+    real_uniform_1i = glad_glUniform1i;
+    glad_glUniform1i = count_uniform_1i;
+    real_uniform_1ui = glad_glUniform1ui;
+    glad_glUniform1ui = count_uniform_1ui;
+    real_uniform_1f = glad_glUniform1f;
+    glad_glUniform1f = count_uniform_1f;
+    real_uniform_3f = glad_glUniform3f;
+    glad_glUniform3f = count_uniform_3f;
+    real_uniform_4f = glad_glUniform4f;
+    glad_glUniform4f = count_uniform_4f;
+    real_uniform_matrix_3fv = glad_glUniformMatrix3fv;
+    glad_glUniformMatrix3fv = count_uniform_matrix_3fv;
+    real_uniform_matrix_4fv = glad_glUniformMatrix4fv;
+    glad_glUniformMatrix4fv = count_uniform_matrix_4fv;
+    real_buffer_data = glad_glBufferData;
+    glad_glBufferData = count_buffer_data;
+    real_buffer_sub_data = glad_glBufferSubData;
+    glad_glBufferSubData = count_buffer_sub_data;
+    real_bind_framebuffer = glad_glBindFramebuffer;
+    glad_glBindFramebuffer = count_bind_framebuffer;
+}
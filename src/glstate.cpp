@@ -0,0 +1,168 @@
+#include <glad/gl.h>
+#include "glstate.h"
+#include "framestats.h"
+
+// Marks a value that has never been set, no real GL value is equal to it
+const uint UNKNOWN = ~0u;
+
+// Texture units that are tracked, binds to higher units always reach the driver
+const uint NUM_TRACKED_UNITS = 32;
+
+// Tracked capabilities, in the order of the enabled array below
+const uint CAPABILITIES[] = {GL_DEPTH_TEST, GL_STENCIL_TEST, GL_CULL_FACE, GL_SCISSOR_TEST, GL_BLEND, GL_COLOR_LOGIC_OP};
+const uint NUM_CAPABILITIES = sizeof(CAPABILITIES) / sizeof(CAPABILITIES[0]);
+
+struct TextureUnit
+{
+    uint texture_2d = UNKNOWN;
+    uint texture_cube_map = UNKNOWN;
+};
+
+struct GLState
+{
+    uint program = UNKNOWN;
+    uint vertex_array = UNKNOWN;
+    uint active_unit = UNKNOWN;
+    TextureUnit units[NUM_TRACKED_UNITS];
+    uint stencil_func = UNKNOWN;
+    int stencil_ref = 0;
+    uint stencil_func_mask = UNKNOWN;
+    uint stencil_fail = UNKNOWN;
+    uint stencil_depth_fail = UNKNOWN;
+    uint stencil_depth_pass = UNKNOWN;
+    uint stencil_mask = UNKNOWN;
+    uint depth_func = UNKNOWN;
+    uint polygon_mode = UNKNOWN;
+    uint enabled[NUM_CAPABILITIES] = {UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN};
+};
+
+GLState state;
+
+// Record the outcome of one call, returns whether it should reach the driver
+bool needs_change(bool changed)
+{
+    if (changed) frame_stats.gl_calls_issued++;
+    else frame_stats.gl_calls_elided++;
+    return changed;
+}
+
+void state_use_program(uint program)
+{
+    if (!needs_change(state.program != program)) return;
+    state.program = program;
+    glUseProgram(program);
+}
+
+void state_bind_vertex_array(uint vertex_array)
+{
+    if (!needs_change(state.vertex_array != vertex_array)) return;
+    state.vertex_array = vertex_array;
+    glBindVertexArray(vertex_array);
+}
+
+void state_bind_texture(uint unit, uint target, uint texture)
+{
+    if (needs_change(state.active_unit != unit))
+    {
+        state.active_unit = unit;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    uint *bound = nullptr;
+    if (unit < NUM_TRACKED_UNITS)
+    {
+        if (target == GL_TEXTURE_2D) bound = &state.units[unit].texture_2d;
+        else if (target == GL_TEXTURE_CUBE_MAP) bound = &state.units[unit].texture_cube_map;
+    }
+    if (bound)
+    {
+        if (!needs_change(*bound != texture)) return;
+        *bound = texture;
+    }
+    else
+    {
+        needs_change(true);
+    }
+    glBindTexture(target, texture);
+}
+
+void state_stencil_func(uint func, int ref, uint mask)
+{
+    bool changed = state.stencil_func != func || state.stencil_ref != ref || state.stencil_func_mask != mask;
+    if (!needs_change(changed)) return;
+    state.stencil_func = func;
+    state.stencil_ref = ref;
+    state.stencil_func_mask = mask;
+    glStencilFunc(func, ref, mask);
+}
+
+void state_stencil_op(uint stencil_fail, uint depth_fail, uint depth_pass)
+{
+    bool changed = state.stencil_fail != stencil_fail || state.stencil_depth_fail != depth_fail || 
+                   state.stencil_depth_pass != depth_pass;
+    if (!needs_change(changed)) return;
+    state.stencil_fail = stencil_fail;
+    state.stencil_depth_fail = depth_fail;
+    state.stencil_depth_pass = depth_pass;
+    glStencilOp(stencil_fail, depth_fail, depth_pass);
+}
+
+void state_stencil_mask(uint mask)
+{
+    if (!needs_change(state.stencil_mask != mask)) return;
+    state.stencil_mask = mask;
+    glStencilMask(mask);
+}
+
+void state_depth_func(uint func)
+{
+    if (!needs_change(state.depth_func != func)) return;
+    state.depth_func = func;
+    glDepthFunc(func);
+}
+
+void state_polygon_mode(uint mode)
+{
+    if (!needs_change(state.polygon_mode != mode)) return;
+    state.polygon_mode = mode;
+    glPolygonMode(GL_FRONT_AND_BACK, mode);
+}
+
+void state_set_capability(uint capability, bool enabled)
+{
+    uint *current = nullptr;
+    for (uint i = 0; i < NUM_CAPABILITIES; i++)
+    {
+        if (CAPABILITIES[i] == capability) current = &state.enabled[i];
+    }
+    if (current)
+    {
+        if (!needs_change(*current != (uint)enabled)) return;
+        *current = enabled;
+    }
+    else
+    {
+        needs_change(true);
+    }
+    if (enabled) glEnable(capability);
+    else glDisable(capability);
+}
+
+void state_forget_program(uint program)
+{
+    if (state.program == program) state.program = UNKNOWN;
+}
+
+void state_forget_vertex_array(uint vertex_array)
+{
+    if (state.vertex_array == vertex_array) state.vertex_array = UNKNOWN;
+}
+
+void state_forget_texture(uint texture)
+{
+    for (TextureUnit &unit : state.units)
+    {
+        if (unit.texture_2d == texture) unit.texture_2d = UNKNOWN;
+        if (unit.texture_cube_map == texture) unit.texture_cube_map = UNKNOWN;
+    }
+}
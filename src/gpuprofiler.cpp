@@ -0,0 +1,116 @@
+#include <iostream>
+#include <climits>
+#include <glad/gl.h>
+#include "gpuprofiler.h"
+
+GpuProfiler::GpuProfiler() : per_draw(false), enabled(false), frame_index(0), track(nullptr), frames_dropped(0)
+{
+    // Timestamps are core since OpenGL 3.3, but a driver may still report a counter of 0 bits
+    GLint counter_bits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &counter_bits);
+    if (counter_bits == 0)
+    {
+        std::cout << "NOTE: no GPU timestamp counter, GPU profiling is off" << std::endl;
+        return;
+    }
+    enabled = true;
+    queries.resize(GPU_PROFILER_FRAMES * GPU_PROFILER_ZONES_PER_FRAME * 2);
+    glGenQueries(queries.size(), queries.data());
+    for (std::vector<const char *> &names : zone_names)
+    {
+        names.reserve(GPU_PROFILER_ZONES_PER_FRAME);
+    }
+    latest_zones.reserve(GPU_PROFILER_ZONES_PER_FRAME);
+    track = profiler_add_track("GPU");
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    if (!enabled)
+    {
+        return;
+    }
+    std::cout << "NOTE: deleting " << queries.size() << " GPU timer queries, ";
+    std::cout << frames_dropped << " frames were not timed since the GPU was behind" << std::endl;
+    glDeleteQueries(queries.size(), queries.data());
+}
+
+uint GpuProfiler::query_of(uint slot, uint zone, bool end) const
+{
+    return queries[(slot * GPU_PROFILER_ZONES_PER_FRAME + zone) * 2 + end];
+}
+
+void GpuProfiler::begin_frame()
+{
+    if (!enabled)
+    {
+        return;
+    }
+    frame_index++;
+    uint slot = frame_index % GPU_PROFILER_FRAMES;
+    collect(slot);
+    zone_names[slot].clear();
+}
+
+void GpuProfiler::collect(uint slot)
+{
+    const std::vector<const char *> &names = zone_names[slot];
+    if (names.empty())
+    {
+        return;
+    }
+
+    // Skip the whole frame rather than wait if any zone has not finished on the GPU
+    for (uint zone = 0; zone < names.size(); zone++)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(query_of(slot, zone, true), GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            frames_dropped++;
+            return;
+        }
+    }
+
+    // Line up the GPU clock with the CPU profiler's, both count nanoseconds
+    GLint64 gpu_now;
+    glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+    int64_t gpu_to_cpu = static_cast<int64_t>(profiler_now()) - gpu_now;
+
+    latest_zones.clear();
+    for (uint zone = 0; zone < names.size(); zone++)
+    {
+        GLuint64 start, end;
+        glGetQueryObjectui64v(query_of(slot, zone, false), GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(query_of(slot, zone, true), GL_QUERY_RESULT, &end);
+        profiler_record(track, names[zone], start + gpu_to_cpu, end + gpu_to_cpu);
+        latest_zones.push_back(GpuZoneTime{names[zone], (end - start) / 1e6f});
+    }
+}
+
+uint GpuProfiler::begin(const char *name)
+{
+    std::vector<const char *> &names = zone_names[frame_index % GPU_PROFILER_FRAMES];
+    if (!enabled || names.size() == GPU_PROFILER_ZONES_PER_FRAME)
+    {
+        return UINT_MAX;
+    }
+    uint zone = names.size();
+    names.push_back(name);
+    glQueryCounter(query_of(frame_index % GPU_PROFILER_FRAMES, zone, false), GL_TIMESTAMP);
+    return zone;
+}
+
+void GpuProfiler::end(uint zone)
+{
+    if (zone == UINT_MAX)
+    {
+        return;
+    }
+    glQueryCounter(query_of(frame_index % GPU_PROFILER_FRAMES, zone, true), GL_TIMESTAMP);
+}
+
+const std::vector<GpuZoneTime> &GpuProfiler::latest() const
+{
+    return latest_zones;
+}
@@ -4,8 +4,10 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "ground.h"
+#include "glstate.h"
+#include "framestats.h"
 
-Ground::Ground(float height, float scale, std::unique_ptr<Texture> diffuse, std::unique_ptr<Texture> specular) 
+Ground::Ground(float height, float scale, std::shared_ptr<Texture> diffuse, std::shared_ptr<Texture> specular) 
                 : diffuse(std::move(diffuse)), specular(std::move(specular))
 {
     // Define triangles
@@ -27,11 +29,13 @@ Ground::Ground(float height, float scale, std::unique_ptr<Texture> diffuse, std:
     glGenVertexArrays(1, &array_obj);
 
     // Copy vertices to GPU
-    glBindVertexArray(array_obj);
+    state_bind_vertex_array(array_obj);
     glBindBuffer(GL_ARRAY_BUFFER, vbuf);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuf);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    gpu_bytes = sizeof(vertices) + sizeof(indices);
+    track_gpu_memory(GPU_MEMORY_GROUND, gpu_bytes);
     
     // Set vertex attribute: position
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)0);
@@ -55,6 +59,8 @@ Ground::Ground(float height, float scale, std::unique_ptr<Texture> diffuse, std:
 Ground::~Ground()
 {
     std::cout << "NOTE: deleting ground, VAO " << array_obj << std::endl;
+    track_gpu_memory(GPU_MEMORY_GROUND, -(int64_t)gpu_bytes);
+    state_forget_vertex_array(array_obj);
     glDeleteVertexArrays(1, &array_obj);
     glDeleteBuffers(1, &ibuf);
     glDeleteBuffers(1, &vbuf);
@@ -72,7 +78,7 @@ void Ground::draw(const Shaders &program) const
     program.uniform_float("material.shininess", 0.01f);
 
     // Bind mesh and issue draw call
-    glBindVertexArray(array_obj);
+    state_bind_vertex_array(array_obj);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 }
 
@@ -0,0 +1,330 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <glad/gl.h>
+#include "hud.h"
+#include "glstate.h"
+
+// Font cells of 4x6 texels holding glyphs of 3x5, for ASCII 32 to 126 and a solid glyph for rectangles
+const uint CELL_WIDTH = 4, CELL_HEIGHT = 6;
+const uint GLYPH_WIDTH = 3, GLYPH_HEIGHT = 5;
+const uint FIRST_CHAR = 32, SOLID_GLYPH = 127;
+const uint NUM_CELLS = SOLID_GLYPH - FIRST_CHAR + 1;
+
+// Screen pixels per font texel, and layout in pixels
+const int SCALE = 2;
+const int ADVANCE = CELL_WIDTH * SCALE;
+const int LINE_HEIGHT = (CELL_HEIGHT + 1) * SCALE;
+const int MARGIN = 10, PADDING = 6;
+const int GRAPH_BAR_WIDTH = 3, GRAPH_HEIGHT = 60;
+const float GRAPH_MAX_MS = 100.f / 3.f; // top of the graph, two frames at 60 Hz
+
+// Rows of each glyph from the top, 3 bits each with the leftmost column in the highest bit.
+// Characters not listed are drawn as '?', lower case as upper case.
+struct Glyph
+{
+    char c;
+    uint8_t rows[GLYPH_HEIGHT];
+};
+const Glyph GLYPHS[] = {
+    {'0', {7, 5, 5, 5, 7}}, {'1', {2, 6, 2, 2, 7}}, {'2', {7, 1, 7, 4, 7}}, {'3', {7, 1, 7, 1, 7}},
+    {'4', {5, 5, 7, 1, 1}}, {'5', {7, 4, 7, 1, 7}}, {'6', {7, 4, 7, 5, 7}}, {'7', {7, 1, 1, 1, 1}},
+    {'8', {7, 5, 7, 5, 7}}, {'9', {7, 5, 7, 1, 7}},
+    {'A', {2, 5, 7, 5, 5}}, {'B', {6, 5, 6, 5, 6}}, {'C', {3, 4, 4, 4, 3}}, {'D', {6, 5, 5, 5, 6}},
+    {'E', {7, 4, 6, 4, 7}}, {'F', {7, 4, 6, 4, 4}}, {'G', {3, 4, 5, 5, 3}}, {'H', {5, 5, 7, 5, 5}},
+    {'I', {7, 2, 2, 2, 7}}, {'J', {1, 1, 1, 5, 2}}, {'K', {5, 5, 6, 5, 5}}, {'L', {4, 4, 4, 4, 7}},
+    {'M', {5, 7, 7, 5, 5}}, {'N', {6, 5, 5, 5, 5}}, {'O', {2, 5, 5, 5, 2}}, {'P', {6, 5, 6, 4, 4}},
+    {'Q', {2, 5, 5, 6, 3}}, {'R', {6, 5, 6, 5, 5}}, {'S', {3, 4, 2, 1, 6}}, {'T', {7, 2, 2, 2, 2}},
+    {'U', {5, 5, 5, 5, 7}}, {'V', {5, 5, 5, 5, 2}}, {'W', {5, 5, 7, 7, 5}}, {'X', {5, 5, 2, 5, 5}},
+    {'Y', {5, 5, 2, 2, 2}}, {'Z', {7, 1, 2, 4, 7}},
+    {'.', {0, 0, 0, 0, 2}}, {',', {0, 0, 0, 2, 4}}, {':', {0, 2, 0, 2, 0}}, {'%', {5, 1, 2, 4, 5}},
+    {'/', {1, 1, 2, 4, 4}}, {'-', {0, 0, 7, 0, 0}}, {'+', {0, 2, 7, 2, 0}}, {'=', {0, 7, 0, 7, 0}},
+    {'(', {2, 4, 4, 4, 2}}, {')', {2, 1, 1, 1, 2}}, {'[', {6, 4, 4, 4, 6}}, {']', {3, 1, 1, 1, 3}},
+    {'<', {1, 2, 4, 2, 1}}, {'>', {4, 2, 1, 2, 4}}, {'_', {0, 0, 0, 0, 7}}, {'|', {2, 2, 2, 2, 2}},
+    {'?', {7, 1, 2, 0, 2}}, {'!', {2, 2, 2, 0, 2}}, {'#', {5, 7, 5, 7, 5}}, {'*', {0, 5, 2, 5, 0}},
+    {'\'', {2, 2, 0, 0, 0}}, {'"', {5, 5, 0, 0, 0}},
+    {(char)SOLID_GLYPH, {7, 7, 7, 7, 7}},
+};
+
+constexpr uint32_t rgba(uint r, uint g, uint b, uint a)
+{
+    return r | g << 8 | b << 16 | a << 24;
+}
+const uint32_t TEXT_COLOR = rgba(230, 230, 230, 255);
+const uint32_t HEADER_COLOR = rgba(255, 210, 90, 255);
+const uint32_t BACKGROUND_COLOR = rgba(0, 0, 0, 170);
+
+// Time of the first GPU zone of a name, or a negative value if there is none
+float gpu_ms_of(const std::vector<GpuZoneTime> &zones, const char *name)
+{
+    for (const GpuZoneTime &zone : zones)
+    {
+        if (std::strcmp(zone.name, name) == 0) return zone.ms;
+    }
+    return -1.f;
+}
+
+Hud::Hud() : next_frame(0), refresh_time(0.f), refresh_frames(0), refresh_max_ms(0.f), num_passes(0), 
+    needs_layout(false), shown_stats(), shown_fps(0.f), shown_ms(0.f), shown_max_ms(0.f), num_shown_passes(0),
+    num_text_vertices(0)
+{
+    std::fill(frame_ms, frame_ms + HUD_GRAPH_FRAMES, 0.f);
+
+    // Rasterize the font, unlisted characters as '?'
+    std::vector<uint8_t> pixels(NUM_CELLS * CELL_WIDTH * CELL_HEIGHT, 0);
+    uint atlas_width = NUM_CELLS * CELL_WIDTH;
+    for (uint cell = 0; cell < NUM_CELLS; cell++)
+    {
+        const Glyph *glyph = nullptr;
+        for (const Glyph &g : GLYPHS)
+        {
+            if ((uint8_t)g.c == cell + FIRST_CHAR || (!glyph && g.c == '?')) glyph = &g;
+        }
+        if (cell + FIRST_CHAR == ' ') continue;
+        for (uint y = 0; y < GLYPH_HEIGHT; y++)
+        {
+            for (uint x = 0; x < GLYPH_WIDTH; x++)
+            {
+                bool set = glyph->rows[y] & (4 >> x);
+                pixels[y * atlas_width + cell * CELL_WIDTH + x] = set ? 255 : 0;
+            }
+        }
+    }
+
+    glGenTextures(1, &font_texture);
+    state_bind_texture(0, GL_TEXTURE_2D, font_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlas_width, CELL_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Vertex layout, the buffer is filled when drawing
+    glGenBuffers(1, &vertex_buffer);
+    glGenVertexArrays(1, &array_obj);
+    state_bind_vertex_array(array_obj);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    glVertexAttribPointer(0, 2, GL_SHORT, GL_FALSE, sizeof(HudVertex), (void*)offsetof(HudVertex, x));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(HudVertex), (void*)offsetof(HudVertex, u));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(HudVertex), (void*)offsetof(HudVertex, color));
+    glEnableVertexAttribArray(2);
+
+    // Enough for a full panel, so that drawing does not allocate
+    vertices.reserve(6 * 4096);
+}
+
+Hud::~Hud()
+{
+    std::cout << "NOTE: deleting HUD, VAO " << array_obj << std::endl;
+    state_forget_vertex_array(array_obj);
+    glDeleteVertexArrays(1, &array_obj);
+    glDeleteBuffers(1, &vertex_buffer);
+    state_forget_texture(font_texture);
+    glDeleteTextures(1, &font_texture);
+}
+
+void Hud::update(float delta_time)
+{
+    frame_ms[next_frame] = delta_time * 1000.f;
+    next_frame = (next_frame + 1) % HUD_GRAPH_FRAMES;
+
+    // Accumulate passes by name
+    uint num_frame_passes;
+    const PassStats *frame = frame_passes(num_frame_passes);
+    for (uint i = 0; i < num_frame_passes; i++)
+    {
+        uint j = 0;
+        while (j < num_passes && passes[j].name != frame[i].name) j++;
+        if (j == MAX_STATS_PASSES) continue;
+        if (j == num_passes) passes[num_passes++] = PassStats{frame[i].name, GLCalls(), 0.f};
+        passes[j].cpu_ms += frame[i].cpu_ms;
+        passes[j].gl.draw_calls += frame[i].gl.draw_calls;
+        passes[j].gl.program_binds += frame[i].gl.program_binds;
+        passes[j].gl.texture_binds += frame[i].gl.texture_binds;
+        passes[j].gl.uniform_uploads += frame[i].gl.uniform_uploads;
+    }
+    refresh_time += delta_time;
+    refresh_frames++;
+    refresh_max_ms = std::max(refresh_max_ms, delta_time * 1000.f);
+    if (refresh_time < HUD_REFRESH_INTERVAL)
+    {
+        return;
+    }
+
+    // Show averages per frame since the last refresh
+    shown_fps = refresh_frames / refresh_time;
+    shown_ms = refresh_time * 1000.f / refresh_frames;
+    shown_max_ms = refresh_max_ms;
+    shown_stats = frame_stats;
+    num_shown_passes = num_passes;
+    for (uint i = 0; i < num_passes; i++)
+    {
+        shown_passes[i] = passes[i];
+        shown_passes[i].cpu_ms /= refresh_frames;
+        shown_passes[i].gl.draw_calls /= refresh_frames;
+        shown_passes[i].gl.program_binds /= refresh_frames;
+        shown_passes[i].gl.texture_binds /= refresh_frames;
+        shown_passes[i].gl.uniform_uploads /= refresh_frames;
+    }
+    needs_layout = true;
+    refresh_time = 0.f;
+    refresh_frames = 0;
+    refresh_max_ms = 0.f;
+    num_passes = 0;
+}
+
+void Hud::add_quad(int x0, int y0, int x1, int y1, uint u0, uint v0, uint u1, uint v1, uint32_t color)
+{
+    HudVertex corners[4] = {
+        {(int16_t)x0, (int16_t)y0, (uint16_t)u0, (uint16_t)v0, color},
+        {(int16_t)x1, (int16_t)y0, (uint16_t)u1, (uint16_t)v0, color},
+        {(int16_t)x1, (int16_t)y1, (uint16_t)u1, (uint16_t)v1, color},
+        {(int16_t)x0, (int16_t)y1, (uint16_t)u0, (uint16_t)v1, color},
+    };
+    const uint ORDER[6] = {0, 1, 2, 0, 2, 3};
+    for (uint i : ORDER)
+    {
+        vertices.push_back(corners[i]);
+    }
+}
+
+void Hud::add_rect(int x0, int y0, int x1, int y1, uint32_t color)
+{
+    // Inside the solid glyph, away from its edges
+    uint u = (SOLID_GLYPH - FIRST_CHAR) * CELL_WIDTH + 1;
+    add_quad(x0, y0, x1, y1, u, 1, u + 1, 2, color);
+}
+
+int Hud::add_text(int x, int y, const char *text, uint32_t color)
+{
+    for (const char *c = text; *c; c++, x += ADVANCE)
+    {
+        uint code = (uint8_t)std::toupper((uint8_t)*c);
+        if (code <= FIRST_CHAR || code >= SOLID_GLYPH) continue;
+        uint u = (code - FIRST_CHAR) * CELL_WIDTH;
+        add_quad(x, y, x + GLYPH_WIDTH * SCALE, y + GLYPH_HEIGHT * SCALE, u, 0, u + GLYPH_WIDTH, GLYPH_HEIGHT, color);
+    }
+    return x;
+}
+
+void Hud::layout_text(const GpuProfiler &gpu_profiler)
+{
+    vertices.clear();
+    char line[128];
+    int x = MARGIN + PADDING;
+    int y = MARGIN + PADDING + GRAPH_HEIGHT + PADDING;
+    int right = MARGIN + PADDING + HUD_GRAPH_FRAMES * GRAPH_BAR_WIDTH;
+
+    std::snprintf(line, sizeof(line), "%.0f fps  frame %.2f ms, max %.2f ms  gpu frame %.2f ms", 
+                  shown_fps, shown_ms, shown_max_ms, gpu_ms_of(gpu_profiler.latest(), "frame"));
+    right = std::max(right, add_text(x, y, line, TEXT_COLOR));
+    y += LINE_HEIGHT + PADDING;
+
+    // Passes, GPU times lag a few frames behind
+    right = std::max(right, add_text(x, y, "pass              cpu ms  gpu ms  draws  binds  uniforms", HEADER_COLOR));
+    y += LINE_HEIGHT;
+    for (uint i = 0; i < num_shown_passes; i++)
+    {
+        const PassStats &pass = shown_passes[i];
+        float gpu_ms = gpu_ms_of(gpu_profiler.latest(), pass.name);
+        char gpu_text[16] = "     -";
+        if (gpu_ms >= 0.f) std::snprintf(gpu_text, sizeof(gpu_text), "%6.3f", gpu_ms);
+        std::snprintf(line, sizeof(line), "%-16.16s  %6.3f  %s  %5u  %5u  %8u", pass.name, pass.cpu_ms, gpu_text,
+                      pass.gl.draw_calls, pass.gl.program_binds + pass.gl.texture_binds, pass.gl.uniform_uploads);
+        right = std::max(right, add_text(x, y, line, TEXT_COLOR));
+        y += LINE_HEIGHT;
+    }
+    y += PADDING;
+
+    // Calls into OpenGL and state changes of the whole frame
+    const FrameStats &stats = shown_stats;
+    std::snprintf(line, sizeof(line), "draws %u  indices %llu  program binds %u  texture binds %u",
+                  stats.gl.draw_calls, (unsigned long long)stats.gl.indices, stats.gl.program_binds, stats.gl.texture_binds);
+    right = std::max(right, add_text(x, y, line, TEXT_COLOR));
+    y += LINE_HEIGHT;
+    std::snprintf(line, sizeof(line), "uniforms %u  buffer uploads %u (%llu kb)  framebuffer binds %u",
+                  stats.gl.uniform_uploads, stats.gl.buffer_uploads, 
+                  (unsigned long long)stats.gl.buffer_upload_bytes / 1024, stats.gl.framebuffer_binds);
+    right = std::max(right, add_text(x, y, line, TEXT_COLOR));
+    y += LINE_HEIGHT;
+    std::snprintf(line, sizeof(line), "state changes %u issued, %u elided  allocations %llu",
+                  stats.gl_calls_issued, stats.gl_calls_elided, (unsigned long long)stats.allocations);
+    right = std::max(right, add_text(x, y, line, TEXT_COLOR));
+    y += LINE_HEIGHT;
+
+    // Culling and memory
+    std::snprintf(line, sizeof(line), "models %u visible, %u culled  meshes %u culled",
+                  stats.models_visible, stats.models_culled, stats.meshes_culled);
+    right = std::max(right, add_text(x, y, line, TEXT_COLOR));
+    y += LINE_HEIGHT;
+    int64_t total_bytes = 0;
+    for (uint kind = 0; kind < NUM_GPU_MEMORY_KINDS; kind++)
+    {
+        total_bytes += gpu_memory(static_cast<GpuMemoryKind>(kind));
+    }
+    std::snprintf(line, sizeof(line), "textures %.1f mb  cube maps %.1f mb  meshes %.1f mb  gpu total %.1f mb",
+                  gpu_memory(GPU_MEMORY_TEXTURES) / 1048576.f, gpu_memory(GPU_MEMORY_CUBE_MAPS) / 1048576.f,
+                  gpu_memory(GPU_MEMORY_MESHES) / 1048576.f, total_bytes / 1048576.f);
+    right = std::max(right, add_text(x, y, line, TEXT_COLOR));
+    y += LINE_HEIGHT;
+
+    // The background goes first so that it is drawn below, its size is known only now
+    size_t num_text = vertices.size();
+    add_rect(MARGIN, MARGIN, right + PADDING, y + PADDING, BACKGROUND_COLOR);
+    std::rotate(vertices.begin(), vertices.begin() + num_text, vertices.end());
+    num_text_vertices = vertices.size();
+}
+
+void Hud::draw(const Shaders &program, const GpuProfiler &gpu_profiler, uint screen_width, uint screen_height)
+{
+    if (needs_layout)
+    {
+        layout_text(gpu_profiler);
+        needs_layout = false;
+    }
+
+    // Frame time graph after the text, oldest frame on the left, with a line at 60 Hz
+    vertices.resize(num_text_vertices);
+    int graph_x = MARGIN + PADDING;
+    int graph_bottom = MARGIN + PADDING + GRAPH_HEIGHT;
+    for (uint i = 0; i < HUD_GRAPH_FRAMES; i++)
+    {
+        float ms = frame_ms[(next_frame + i) % HUD_GRAPH_FRAMES];
+        int height = static_cast<int>(std::min(ms / GRAPH_MAX_MS, 1.f) * GRAPH_HEIGHT);
+        uint32_t color = ms < 17.f ? rgba(90, 200, 90, 255) : ms < 34.f ? rgba(230, 200, 60, 255) : rgba(230, 70, 60, 255);
+        int x = graph_x + i * GRAPH_BAR_WIDTH;
+        add_rect(x, graph_bottom - height, x + GRAPH_BAR_WIDTH - 1, graph_bottom, color);
+    }
+    int line_y = graph_bottom - GRAPH_HEIGHT / 2;
+    add_rect(graph_x, line_y, graph_x + HUD_GRAPH_FRAMES * GRAPH_BAR_WIDTH, line_y + 1, rgba(255, 255, 255, 120));
+
+    // Upload into fresh storage, so that the previous frame's draw never stalls it
+    state_bind_vertex_array(array_obj);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(HudVertex), vertices.data(), GL_STREAM_DRAW);
+
+    // Blend on top of everything, in one draw call
+    state_set_capability(GL_DEPTH_TEST, false);
+    state_set_capability(GL_CULL_FACE, false);
+    state_polygon_mode(GL_FILL);
+    state_set_capability(GL_BLEND, true);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    program.use();
+    state_bind_texture(0, GL_TEXTURE_2D, font_texture);
+    program.uniform_int("font", 0);
+    program.uniform_float("screen_width", screen_width);
+    program.uniform_float("screen_height", screen_height);
+    glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+
+    // Restore state
+    state_set_capability(GL_BLEND, false);
+    state_set_capability(GL_CULL_FACE, true);
+    state_set_capability(GL_DEPTH_TEST, true);
+}
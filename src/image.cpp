@@ -0,0 +1,59 @@
+#include <iostream>
+#include <glad/gl.h>
+#include "stb_image.h"
+#include "image.h"
+#include "profiler.h"
+
+Image::Image(const unsigned char *file_data, size_t file_size, const std::string &filepath) : 
+    width(0), height(0), channels(0), filepath(filepath)
+{
+    PROFILE_ZONE("Image::Image");
+    pixels = stbi_load_from_memory(file_data, file_size, &width, &height, &channels, 0);
+    if (!pixels)
+    {
+        std::cout << "Failed to load texture" << std::endl;
+        std::cout << filepath << std::endl;
+    }
+}
+
+Image::Image(const std::string &filepath) : 
+    width(0), height(0), channels(0), filepath(filepath)
+{
+    PROFILE_ZONE("Image::Image");
+    pixels = stbi_load(filepath.c_str(), &width, &height, &channels, 0);
+    if (!pixels)
+    {
+        std::cout << "Failed to load texture" << std::endl;
+        std::cout << filepath << std::endl;
+    }
+}
+
+Image::~Image()
+{
+    stbi_image_free(pixels);
+}
+
+bool Image::is_valid() const
+{
+    return pixels != nullptr;
+}
+
+uint Image::gl_format() const
+{
+    // Infere RGB or RGBA from number of channels
+    GLenum format = GL_RGB;
+    switch (channels)
+    {
+    case 3:
+        // Keep it GL_RGB
+        break;
+    case 4:
+        format = GL_RGBA;
+        break;
+    default:
+        std::cout << "Error: unsupported number of channels " << channels;
+        std::cout << " in texture " << filepath << std::endl;
+        break;
+    }
+    return format;
+}
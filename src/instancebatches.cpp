@@ -0,0 +1,48 @@
+#include "instancebatches.h"
+
+void InstanceBatches::clear()
+{
+    for (Batch &batch : batches)
+    {
+        batch.instances.clear();
+    }
+}
+
+void InstanceBatches::add(const Model &model, uint object_id)
+{
+    const ModelAsset *asset = &model.get_asset();
+    Batch *found = nullptr;
+    for (Batch &batch : batches)
+    {
+        if (batch.asset == asset)
+        {
+            found = &batch;
+            break;
+        }
+    }
+    if (!found)
+    {
+        found = &batches.emplace_back(Batch{asset, {}});
+    }
+    glm::mat3 m_for_normals = glm::transpose(glm::inverse(model.world_transform));
+    found->instances.emplace_back(InstanceData{model.world_transform, m_for_normals, object_id});
+}
+
+void InstanceBatches::queue(RenderQueue &queue, const Shaders &program, bool with_textures,
+                            const Frustum *frustum, glm::vec3 eye, const Shaders *program_without_specular) const
+{
+    for (const Batch &batch : batches)
+    {
+        batch.asset->queue_instanced(queue, program, with_textures, batch.instances, frustum, eye, program_without_specular);
+    }
+}
+
+size_t InstanceBatches::num_batches() const
+{
+    size_t num = 0;
+    for (const Batch &batch : batches)
+    {
+        if (!batch.instances.empty()) num++;
+    }
+    return num;
+}
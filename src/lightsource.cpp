@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "lightsource.h"
+#include "glstate.h"
 
 #define PI 3.14159f
 extern float light_strength;
@@ -23,7 +24,7 @@ LightSource::LightSource(glm::vec3 position, glm::vec3 color) : color(color), sp
     glGenVertexArrays(1, &array_obj);
 
     // Copy vertices to GPU
-    glBindVertexArray(array_obj);
+    state_bind_vertex_array(array_obj);
     glBindBuffer(GL_ARRAY_BUFFER, vbuf);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
     
@@ -47,6 +48,7 @@ LightSource::LightSource(glm::vec3 position, glm::vec3 color) : color(color), sp
 LightSource::~LightSource()
 {
     std::cout << "NOTE: deleting lightsource, VAO " << array_obj << std::endl;
+    state_forget_vertex_array(array_obj);
     glDeleteVertexArrays(1, &array_obj);
     glDeleteBuffers(1, &vbuf);
 }
@@ -60,17 +62,18 @@ void LightSource::update(float delta_time)
     model = rotation_matrix * model;
 }
 
-void LightSource::use(const Shaders &program) const
+void LightSource::use(LightData &data) const
 {
-    program.uniform_vec3("light.color", color);
-    program.uniform_float("light.diffuse_intensity", 0.9);
-    program.uniform_float("light.specular_intensity", 0.9);
-    program.uniform_float("light.strength", light_strength);
-    program.uniform_vec3("light.position", model * origin);
+    data.color = glm::vec4(color, 0.f);
+    data.diffuse_intensity = 0.9;
+    data.specular_intensity = 0.9;
+    data.strength = light_strength;
+    data.position = model * origin;
+    data.is_on = 1.f;
 }
 
 void LightSource::draw() const
 {
-    glBindVertexArray(array_obj);
+    state_bind_vertex_array(array_obj);
     glDrawArrays(GL_POINTS, 0, 1);
 }
\ No newline at end of file
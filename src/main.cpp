@@ -1,13 +1,29 @@
 #include <iostream>
 #include <memory>
-#include <filesystem>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cerrno>
 
 #include <glad/gl.h>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "model.h"
+#include "sceneloader.h"
+#include "instancebatches.h"
+#include "frustum.h"
+#include "renderqueue.h"
+#include "picker.h"
 #include "shaders.h"
+#include "programwarmup.h"
+#include "benchmark.h"
+#include "profiler.h"
+#include "gpuprofiler.h"
+#include "shadervariants.h"
+#include "frameuniforms.h"
+#include "glstate.h"
 #include "texture.h"
+#include "texturecache.h"
 #include "clock.h"
 #include "window.h"
 #include "camera.h"
@@ -16,26 +32,51 @@
 #include "sun.h"
 #include "ground.h"
 #include "selection.h"  
+#include "outline.h"
+#include "marquee.h"
+#include "hud.h"
 #include "skybox.h"
+#include "skyboxlibrary.h"
+#include "framestats.h"
 #include "Zm.h"
 
 #define WINDOW_WIDTH 1200
 #define WINDOW_HEIGHT 900
 #define PI 3.14159f
+#define MAX_LOAD_THREADS 256
+#define MAX_CRATES 100000
 
-namespace fs = std::filesystem;
 using Scene = std::vector<std::unique_ptr<Model>>;
 
 // From callbacks.cpp
-extern bool mode_selection; 
+extern bool mode_selection;
+extern bool mode_hud; 
+extern bool is_sun, is_flashlight;
+extern float camera_pitch, camera_yaw;
+extern double last_mouse_x, last_mouse_y;
 extern bool mouse_clicked;
 extern uint click_x, click_y;
+extern bool marquee_requested;
+extern bool trace_requested;
+extern double marquee_x0, marquee_y0, marquee_x1, marquee_y1;
 
 Zm render_mode(5); // 0 - Full, 1 - Wireframe, 2 - Depth, 3 - EnvMap Reflect, 4 - EnvMap Refract
+const std::vector<std::string> RENDER_MODE_NAMES = {"default", "wireframe", "depth", "envmap_reflect", "envmap_refract"};
 std::unique_ptr<Zm> cur_skybox; // Determine m (number of skyboxes) on runtime
+Zm picking_mode(3); // 0 - IDs in main pass, 1 - Separate ID pass, 2 - CPU ray cast
 
-void populate_scene(Scene &models)
+void populate_scene(Scene &models, uint load_threads, uint num_crates)
 {
+    PROFILE_ZONE("populate_scene");
+
+    // Read all model files in parallel first, placements below then share the resident assets
+    SceneLoader loader(load_threads);
+    loader.request("resources/backpack/backpack.obj");
+    loader.request("resources/cbox/cbox.obj");
+    loader.request("resources/playground/KIDS_PLAYGROUND.obj");
+    loader.load_all();
+    loader.print_timings();
+
     models.emplace_back(std::make_unique<Model>("resources/backpack/backpack.obj"));
     models.back()->translate(-3.f, -.3f, 1.f);
     models.back()->rotate(PI * 7.f/10.f, 0.f, 1.f, 0.f);
@@ -56,28 +97,118 @@ void populate_scene(Scene &models)
     
     models.emplace_back(std::make_unique<Model>("resources/playground/KIDS_PLAYGROUND.obj"));
     models.back()->translate(4.f, -1.f, 7.f);
+
+    // Extra crates on a square grid behind the playground, for stress testing
+    uint side = std::ceil(std::sqrt((float)num_crates));
+    for (uint i = 0; i < num_crates; i++)
+    {
+        models.emplace_back(std::make_unique<Model>("resources/cbox/cbox.obj"));
+        models.back()->translate(1.2f * (i % side) - .6f * side, -.5f, 12.f + 1.2f * (i / side));
+        models.back()->scale(0.5);
+    }
 }
 
-void set_transforms(const Shaders &program, const Camera &camera, const glm::mat4 &model_transform)
+void set_transforms(const Shaders &program, const glm::mat4 &model_transform, uint object_id = 0)
 {
-    glm::mat4 mvp = camera.get_projection() * camera.get_view() * model_transform;
+    // Camera transformations are shared by all programs through the FrameData block
     program.use();
+    program.uniform_uint("object_id", object_id);
     program.uniform_mat4("m", model_transform);
-    program.uniform_mat4("mvp", mvp);
     program.uniform_mat3("m_for_normals", glm::transpose(glm::inverse(model_transform)));
-    program.uniform_vec3("camera_position", camera.position);
 }
 
-int main()
+Ray ray_at(const Camera &camera, double window_x, double window_y)
 {
-    // Open window and initialize OpenGL
+    // Window coordinates have their origin at the top left, NDC at the center with y up
+    float ndc_x = 2.f * (window_x + .5f) / WINDOW_WIDTH - 1.f;
+    float ndc_y = 1.f - 2.f * (window_y + .5f) / WINDOW_HEIGHT;
+    return camera.ray_through(ndc_x, ndc_y);
+}
+
+// Parses a non-negative decimal count no larger than max_value, anything else is rejected
+bool parse_count(const char *text, uint max_value, uint &value)
+{
+    if (*text < '0' || *text > '9')  return false; // strtoul would accept signs and whitespace
+    char *end;
+    errno = 0;
+    unsigned long parsed = std::strtoul(text, &end, 10);
+    if (*end != '\0' || errno == ERANGE || parsed > max_value)  return false;
+    value = static_cast<uint>(parsed);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    profiler_set_thread_name("main");
+
+    // Parse command line
+    uint load_threads = 0; // 0 means one per hardware thread
+    uint num_crates = 0;
+    std::string bench_path, bench_output = "bench_results.json";
+    std::string trace_output = "trace.json";
+    bool trace_at_exit = false;
+    bool gpu_per_draw = false;
+    bool valid_args = true;
+    for (int i = 1; valid_args && i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--load-threads" && i + 1 < argc)
+        {
+            valid_args = parse_count(argv[++i], MAX_LOAD_THREADS, load_threads);
+        }
+        else if (arg == "--crates" && i + 1 < argc)
+        {
+            valid_args = parse_count(argv[++i], MAX_CRATES, num_crates);
+        }
+        else if (arg == "--trace" && i + 1 < argc)
+        {
+            trace_output = argv[++i];
+            trace_at_exit = true;
+        }
+        else if (arg == "--gpu-per-draw")
+        {
+            gpu_per_draw = true;
+        }
+        else if (arg == "--bench" && i + 1 < argc)
+        {
+            bench_path = argv[++i];
+        }
+        else if (arg == "--bench-out" && i + 1 < argc)
+        {
+            bench_output = argv[++i];
+        }
+        else
+        {
+            valid_args = false;
+        }
+    }
+    if (!valid_args)
+    {
+        std::cout << "Usage: " << argv[0] << " [--load-threads N] [--crates N] [--trace FILE] [--gpu-per-draw] [--bench PATH_FILE [--bench-out FILE]]" << std::endl;
+        return -1;
+    }
+
+    // Open window and initialize OpenGL, benchmarks run headless
     bool init_success;
-    Window window(WINDOW_WIDTH, WINDOW_HEIGHT, init_success);
+    bool headless = !bench_path.empty();
+    Window window(WINDOW_WIDTH, WINDOW_HEIGHT, headless, init_success);
     if (!init_success)  return -1;
+    std::unique_ptr<Benchmark> bench;
+    if (headless)
+    {
+        bench = std::make_unique<Benchmark>(bench_path, RENDER_MODE_NAMES, init_success);
+        if (!init_success)  return -1;
+    }
 
-    // Build shaders programs
+    // Time passes on the GPU into the same trace as the CPU zones
+    GpuProfiler gpu_profiler;
+    gpu_profiler.per_draw = gpu_per_draw;
+
+    // Start building shader programs, they finish in the background while assets load and the first frames draw
+    ProgramWarmup warmup(init_success);
+    if (!init_success)  return -1;
     bool shader_success;
-    Shaders program_default("shaders/vertex.glsl", "shaders/fragment.glsl", shader_success);
+    ShaderVariants program_lit("shaders/vertex.glsl", "shaders/fragment.glsl", warmup, shader_success);
     if (!shader_success)  return -1; 
     Shaders program_light("shaders/vertex.glsl", "shaders/fragment_light.glsl", shader_success);
     if (!shader_success)  return -1;
@@ -91,6 +222,21 @@ int main()
     if (!shader_success)  return -1;
     Shaders program_depth("shaders/vertex.glsl", "shaders/fragment_depth.glsl", shader_success);
     if (!shader_success)  return -1;
+    Shaders program_outline("shaders/vertex_fullscreen.glsl", "shaders/fragment_outline.glsl", shader_success);
+    if (!shader_success)  return -1;
+    Shaders program_marquee("shaders/vertex_marquee.glsl", "shaders/fragment_marquee.glsl", shader_success);
+    if (!shader_success)  return -1;
+    Shaders program_hud("shaders/vertex_hud.glsl", "shaders/fragment_hud.glsl", shader_success);
+    if (!shader_success)  return -1;
+    warmup.add(program_skybox);
+    warmup.add(program_light);
+    warmup.add(program_outline);
+    warmup.add(program_object_id);
+    warmup.add(program_depth);
+    warmup.add(program_em_reflect);
+    warmup.add(program_em_refract);
+    warmup.add(program_marquee);
+    warmup.add(program_hud);
 
     // Create camera
     glm::vec3 camera_position(0.f, 0.f, -10.f);
@@ -99,54 +245,187 @@ int main()
     const float aspect_ratio = (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT;
     Camera camera(camera_position, camera_direction, world_up, aspect_ratio);
 
+    // Per-frame camera and lighting data, read by every program above through the FrameData block
+    FrameUniforms frame_uniforms;
+    frame_uniforms.data.ambient_light_intensity = .2f;
+
     // Construct light sources to render
     // Point light
     LightSource lightsource(glm::vec3(0.f, 0.f, -6.f), glm::vec3(1.f, 1.f, 1.f));
-    program_light.use();
-    program_light.uniform_vec3("color", lightsource.color);
-    program_default.use();
-    program_default.uniform_float("ambient_light_intensity", .2f);
     // Sunlight
     Sun sun(glm::vec3(0.f, -1.f, 0.f));
     // Flashlight
     Flashlight flashlight(-.1f*PI, .1f*PI, -.65f*PI, - .35f*PI);
     
     // Load scenes
+    auto load_start = std::chrono::steady_clock::now();
     Scene scene;
-    populate_scene(scene);
+    populate_scene(scene, load_threads, num_crates);
+    std::chrono::duration<float, std::milli> load_time = std::chrono::steady_clock::now() - load_start;
+    std::cout << "Scene loaded in " << load_time.count() << "ms" << std::endl;
+    ModelAsset::print_registry_stats();
     Ground ground(-1.f, 15,
-        std::make_unique<Texture>("resources/ground.jpg", TextureType::Diffuse), 
-        std::make_unique<Texture>("resources/blank.png", TextureType::Specular));
-    std::vector<std::unique_ptr<Skybox>> skies;
-    for (const fs::directory_entry &entry : fs::directory_iterator("resources/skyboxes"))
-    {
-        std::string textures = entry.path().string();
-        skies.emplace_back(std::make_unique<Skybox>(textures));
-    }
-    cur_skybox = std::make_unique<Zm>(skies.size());
+        TextureCache::get("resources/ground.jpg"), 
+        TextureCache::get("resources/blank.png"));
+    Skybox skybox;
+    SkyboxLibrary skyboxes("resources/skyboxes");
+    cur_skybox = std::make_unique<Zm>(skyboxes.size());
+    TextureCache::print_stats();
     
-    // Prepare object selection mechanism
+    // Prepare object selection mechanisms
     Selection selection(WINDOW_WIDTH, WINDOW_HEIGHT, init_success);
     if (!init_success)  return -1;
-    std::vector<bool> is_selected(scene.size(), false);
+    RayPicker picker;
+    picker.build(scene);
+    Outline outline;
+    std::vector<uint8_t> scene_selected;
+    Marquee marquee(scene.size() + 1, WINDOW_WIDTH, WINDOW_HEIGHT, init_success);
+    if (!init_success)  return -1;
+    std::vector<uint> marquee_ids;
+
+    // Performance overlay
+    Hud hud;
+
+    // Placements grouped by asset for instanced drawing, submitted sorted by state, reused every frame
+    InstanceBatches batches;
+    RenderQueue render_queue;
+
+    // View volume and world bounds of all placements, for skipping what is off-screen
+    Frustum frustum;
+    PackedSpheres scene_bounds;
+    std::vector<uint8_t> scene_visible;
 
     // Loop until the user closes the window
     Clock clock;
     while (window.next_frame_ready())
     {
+        gpu_profiler.begin_frame();
+        PROFILE_ZONE("frame");
+        GPU_PROFILE_ZONE(gpu_profiler, "frame");
+
         // Keep time since last frame and update camera
         float delta_time = clock.tick();
-        camera.update(delta_time);
-        const glm::mat4 &view_matrix = camera.get_view();
-        const glm::mat4 &proj_matrix = camera.get_projection();
+        begin_frame_stats();
+        {
+            PROFILE_ZONE("program warmup");
+            if (!warmup.update())  return -1;
+        }
+        if (bench)
+        {
+            // Fly the path at a fixed time step, overriding user input
+            if (!bench->begin_frame(warmup.done(), camera.position, camera_yaw, camera_pitch, render_mode.value))  break;
+            delta_time = Benchmark::FRAME_TIME;
+        }
+        {
+            PROFILE_ZONE("camera update");
+            camera.update(delta_time);
+            lightsource.update(delta_time);
+        }
+
+        // Upload camera and lights once, shared by all programs drawing this frame
+        FrameData &frame_data = frame_uniforms.data;
+        frame_data.view = camera.get_view();
+        frame_data.projection = camera.get_projection();
+        frame_data.vp = frame_data.projection * frame_data.view;
+        frame_data.camera_position = glm::vec4(camera.position, 1.f);
+        lightsource.use(frame_data.light);
+        sun.use(frame_data.sun);
+        flashlight.use(frame_data.flashlight, frame_data.view);
+
+        // Track the object under the cursor, written by the main pass for free when it renders IDs
+        bool render_ids = mode_selection && picking_mode.value == 0;
+        bool ray_picking = mode_selection && picking_mode.value == 2;
+        bool cursor_inside = last_mouse_x >= 0 && last_mouse_x < WINDOW_WIDTH && last_mouse_y >= 0 && last_mouse_y < WINDOW_HEIGHT;
+        if (ray_picking)
+        {
+            PROFILE_ZONE("ray picking");
+            // Cast rays right away, placements may have moved since the last frame
+            picker.refit(scene);
+            RayHit hit;
+            frame_data.hovered_object_id = 0;
+            if (cursor_inside && picker.cast(ray_at(camera, last_mouse_x, last_mouse_y), hit))
+            {
+                frame_data.hovered_object_id = hit.object + 1;
+            }
+            if (mouse_clicked)
+            {
+                auto cast_start = std::chrono::steady_clock::now();
+                bool is_hit = picker.cast(ray_at(camera, click_x, click_y), hit);
+                std::chrono::duration<float, std::micro> cast_time = std::chrono::steady_clock::now() - cast_start;
+                if (is_hit)
+                {
+                    Model &selected = *scene[hit.object];
+                    selected.is_selected = !selected.is_selected;
+                    std::cout << "Object at (" << click_x << "," << click_y << ") is " << hit.object + 1;
+                    std::cout << ", triangle " << hit.triangle << " at distance " << hit.distance;
+                    std::cout << " (ray cast in " << cast_time.count() << "us)" << std::endl;
+                }
+                mouse_clicked = false;
+            }
+        }
+        else if (mode_selection && cursor_inside)
+        {
+            selection.request_hover(static_cast<uint>(last_mouse_x), WINDOW_HEIGHT - 1 - static_cast<uint>(last_mouse_y));
+        }
+        else
+        {
+            frame_data.hovered_object_id = 0;
+        }
+        frame_uniforms.upload();
+
+        // Cull placements outside the view, all at once
+        {
+            PROFILE_ZONE("frustum culling");
+            frustum.update(frame_data.vp);
+            scene_bounds.clear();
+            for (const std::unique_ptr<Model> &model : scene)
+            {
+                glm::vec3 center;
+                float radius;
+                model->world_bounds(center, radius);
+                scene_bounds.add(center, radius);
+            }
+            frustum.cull(scene_bounds, scene_visible);
+            for (uint8_t visible : scene_visible)
+            {
+                if (visible) frame_stats.models_visible++;
+                else frame_stats.models_culled++;
+            }
+        }
         
-        // Initialize default rendering mode
-        Shaders *cur_program = &program_default;
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        // Initialize default rendering mode, with only the lights that are on compiled in
+        uint light_features = FEATURE_POINT_LIGHT;
+        if (is_sun) light_features |= FEATURE_SUN;
+        if (is_flashlight) light_features |= FEATURE_FLASHLIGHT;
+        const Shaders &program_default = program_lit.get(light_features | FEATURE_SPECULAR_MAP);
+        const Shaders &program_default_no_specular = program_lit.get(light_features);
+        const Shaders *cur_program = &program_default;
+        state_polygon_mode(GL_FILL);
+
+        // Selected objects are outlined from the object IDs of the main pass
+        scene_selected.assign(scene.size() + 1, 0);
+        for (size_t i = 0; i < scene.size(); i++)
+        {
+            scene_selected[i + 1] = scene[i]->is_selected;
+        }
+        outline.set_selected(scene_selected);
+        bool run_marquee = marquee_requested && marquee.ready() && program_marquee.usable();
+        bool scene_offscreen = render_ids || outline.any_selected() || run_marquee;
+
+        // Render color and object IDs together off-screen if picking in a single pass, outlining or box selecting
+        if (scene_offscreen)
+        {
+            selection.start_scene();
+        }
 
         // Draw skybox
-        program_skybox.use();
-        skies[cur_skybox->value]->draw(program_skybox, view_matrix, proj_matrix);
+        skyboxes.select(cur_skybox->value);
+        skyboxes.update();
+        if (program_skybox.usable())
+        {
+            PROFILE_PASS(gpu_profiler, "skybox");
+            skybox.draw(program_skybox, skyboxes.current());
+        }
 
         // Handle render modes
         switch (render_mode.value)
@@ -155,7 +434,7 @@ int main()
             // Already initialized above
             break;
         case 1:
-            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+            state_polygon_mode(GL_LINE);
             break;
         case 2:
             cur_program = &program_depth;
@@ -171,73 +450,153 @@ int main()
             return -1;
         }
 
+        // Draw with the default program until the mode's own is warmed up, and nothing until that is
+        if (!cur_program->usable())
+        {
+            cur_program = &program_default;
+        }
+        bool draw_scene = cur_program->usable();
+
         // Render light source (emissive small box)
-        lightsource.update(delta_time);
-        set_transforms(program_light, camera, lightsource.model);
-        lightsource.draw();
-
-        // Setup lighting of all objects
-        cur_program->use();
-        lightsource.use(*cur_program);
-        sun.use(*cur_program);
-        flashlight.use(*cur_program, view_matrix);
+        if (program_light.usable())
+        {
+            PROFILE_PASS(gpu_profiler, "light source");
+            set_transforms(program_light, lightsource.model);
+            program_light.uniform_vec3("color", lightsource.color);
+            lightsource.draw();
+        }
         
         // Draw ground (in default, wireframe, depth modes only)
-        if (render_mode.value <= 2) 
+        if (draw_scene && render_mode.value <= 2) 
         {
-            set_transforms(*cur_program, camera, ground.model_transform);
+            PROFILE_PASS(gpu_profiler, "ground");
+            set_transforms(*cur_program, ground.model_transform);
             ground.draw(*cur_program);
         }
 
-        // Draw scene (non-selected objects only)
-        uint object_id = 0;
-        for (const std::unique_ptr<Model> &model : scene)
+        // Draw scene, one instanced draw per mesh of every asset
         {
-            if (!is_selected[object_id++])
+            PROFILE_PASS(gpu_profiler, "scene");
+            batches.clear();
+            render_queue.clear();
+            for (size_t i = 0; draw_scene && i < scene.size(); i++)
             {
-                set_transforms(*cur_program, camera, model->world_transform);
-                model->draw(*cur_program, true);
+                if (scene_visible[i])
+                {
+                    batches.add(*scene[i], i + 1);
+                }
+            }
+            const Shaders *program_without_specular = nullptr;
+            if (cur_program == &program_default && program_default_no_specular.usable())
+            {
+                program_without_specular = &program_default_no_specular;
             }
+            batches.queue(render_queue, *cur_program, true, &frustum, camera.position, program_without_specular);
+            render_queue.submit(gpu_profiler.per_draw ? &gpu_profiler : nullptr);
         }
 
-        // Draw scene (selected objects only, always on top)
-        object_id = 0;
-        for (const std::unique_ptr<Model> &model : scene)
+        // Clicks are read from the object IDs of this frame
+        if (mode_selection && mouse_clicked)
         {
-            if (is_selected[object_id++]) 
-            {
-                set_transforms(*cur_program, camera, model->world_transform);
-                set_transforms(program_light, camera, glm::scale(model->world_transform, glm::vec3(1.1f)));
-                model->draw_with_outline(*cur_program, program_light);
-            }
+            selection.request_pick(click_x, WINDOW_HEIGHT - 1 - click_y);
+            mouse_clicked = false;
+        }
+
+        // Present the main pass, reading back IDs if requested, then outline selected objects on screen
+        if (scene_offscreen)
+        {
+            PROFILE_PASS(gpu_profiler, "end scene");
+            selection.end_scene(render_ids);
+        }
+        if (outline.any_selected() && program_outline.usable())
+        {
+            PROFILE_PASS(gpu_profiler, "outline");
+            outline.draw(program_outline, selection.ids(), lightsource.color);
+        }
+
+        // Box select from the object IDs of this frame, corners are clamped to the window
+        if (run_marquee)
+        {
+            PROFILE_PASS(gpu_profiler, "marquee");
+            auto to_column = [](double x) { return static_cast<uint>(glm::clamp(x, 0.0, WINDOW_WIDTH - 1.0)); };
+            auto to_row = [](double y) { return WINDOW_HEIGHT - 1 - static_cast<uint>(glm::clamp(y, 0.0, WINDOW_HEIGHT - 1.0)); };
+            marquee.start(program_marquee, selection.ids(), 
+                          to_column(marquee_x0), to_row(marquee_y0), to_column(marquee_x1), to_row(marquee_y1));
+            marquee_requested = false;
         }
 
-        // Second render pass off-screen for object selection
-        if (mode_selection)
+        // Otherwise, second render pass off-screen for object selection, only when a read is pending
+        if (!render_ids && selection.needs_pass() && program_object_id.usable())
         {
+            PROFILE_PASS(gpu_profiler, "object ID pass");
+
+            // Only objects that cover the pixel being read can be hit, so cull against that pixel's frustum
             selection.start();
+            glm::vec4 viewport(0.f, 0.f, WINDOW_WIDTH, WINDOW_HEIGHT);
+            glm::vec2 pixel_center(selection.read_x + .5f, selection.read_y + .5f);
+            glm::mat4 pick_projection = glm::pickMatrix(pixel_center, glm::vec2(1.f), viewport);
+            Frustum pick_frustum;
+            pick_frustum.update(pick_projection * frame_data.vp);
+
             program_object_id.use();
-            uint object_id = 1; 
-            for (const std::unique_ptr<Model> &model : scene)
+            for (size_t i = 0; i < scene.size(); i++)
             {
-                program_object_id.uniform_uint("object_id", object_id++);
-                set_transforms(program_object_id, camera, model->world_transform);
-                model->draw(program_object_id, false);
+                glm::vec3 center(scene_bounds.x[i], scene_bounds.y[i], scene_bounds.z[i]);
+                if (!pick_frustum.intersects(center, scene_bounds.radius[i])) continue;
+                set_transforms(program_object_id, scene[i]->world_transform, i + 1);
+                scene[i]->draw(program_object_id, false, &pick_frustum);
             }
-            if (mouse_clicked)
+            selection.end();
+        }
+
+        // Apply finished read backs, a frame or two after they were requested
+        uint read_object_id;
+        bool is_click;
+        if (selection.poll(read_object_id, is_click))
+        {
+            if (is_click && read_object_id > 0 && read_object_id <= scene.size())
             {
-                uint selected_object_id = selection.object_at(click_x, WINDOW_HEIGHT - click_y);
-                if (selected_object_id > 0)
-                {
-                    is_selected[selected_object_id - 1] = !is_selected[selected_object_id - 1];
-                    std::cout << "Object at (" << click_x << "," << click_y << ") ";
-                    std::cout << "is " << selection.object_at(click_x, WINDOW_HEIGHT - click_y) << std::endl;
-                }
-                mouse_clicked = false;
+                Model &selected = *scene[read_object_id - 1];
+                selected.is_selected = !selected.is_selected;
+                std::cout << "Object at (" << selection.read_x << "," << WINDOW_HEIGHT - 1 - selection.read_y << ") ";
+                std::cout << "is " << read_object_id << std::endl;
             }
-            selection.end();
+            else if (!is_click)
+            {
+                frame_data.hovered_object_id = read_object_id;
+            }
+        }
+
+        if (marquee.poll(marquee_ids))
+        {
+            for (uint object_id : marquee_ids)
+            {
+                if (object_id <= scene.size()) scene[object_id - 1]->is_selected = true;
+            }
+            std::cout << "Box selected " << marquee_ids.size() << " objects" << std::endl;
+        }
+
+        // Overlay performance data (key 9) after all other passes
+        if (mode_hud && program_hud.usable())
+        {
+            PROFILE_PASS(gpu_profiler, "hud");
+            hud.draw(program_hud, gpu_profiler, WINDOW_WIDTH, WINDOW_HEIGHT);
+        }
+
+        // Record this frame for the overlay once its stats are complete
+        if (bench)  bench->end_frame();
+        end_frame_stats(delta_time);
+        hud.update(delta_time);
+
+        // Export the latest profiler zones on request (key 8)
+        if (trace_requested)
+        {
+            profiler_export(trace_output);
+            trace_requested = false;
         }
     }
 
+    if (trace_at_exit)  profiler_export(trace_output);
+    if (bench && !bench->write_report(bench_output))  return -1;
     return 0;
 }
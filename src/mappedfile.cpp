@@ -0,0 +1,39 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mappedfile.h"
+
+MappedFile::MappedFile(const std::string &filepath) : data(nullptr), size(0)
+{
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0)
+    {
+        void *mapped = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            data = static_cast<const unsigned char *>(mapped);
+            size = file_stat.st_size;
+        }
+    }
+    // The mapping stays valid after closing the descriptor
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data)
+    {
+        munmap(const_cast<unsigned char *>(data), size);
+    }
+}
+
+bool MappedFile::is_open() const
+{
+    return data != nullptr;
+}
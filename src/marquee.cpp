@@ -0,0 +1,124 @@
+#include <iostream>
+#include <algorithm>
+#include <glad/gl.h>
+#include "marquee.h"
+#include "glstate.h"
+
+// Words per row of the bitmap, rows are added as needed
+const uint MAX_BITMAP_WIDTH = 256;
+
+uint bitmap_width_for(uint num_ids)
+{
+    uint num_words = (num_ids + 31) / 32;
+    return std::min(std::max(num_words, 1u), MAX_BITMAP_WIDTH);
+}
+
+uint bitmap_height_for(uint num_ids)
+{
+    uint num_words = (num_ids + 31) / 32;
+    uint width = bitmap_width_for(num_ids);
+    return std::max((num_words + width - 1) / width, 1u);
+}
+
+Marquee::Marquee(uint num_ids, uint window_width, uint window_height, bool &success) :
+    window_width(window_width), window_height(window_height), 
+    bitmap_width(bitmap_width_for(num_ids)), bitmap_height(bitmap_height_for(num_ids)),
+    readback(bitmap_width * bitmap_height * sizeof(uint))
+{
+    success = true;
+
+    // Create texture (bitmap of object IDs)
+    glGenTextures(1, &texture_id);
+    state_bind_texture(0, GL_TEXTURE_2D, texture_id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, bitmap_width, bitmap_height, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // Create framebuffer, without depth or stencil since points only accumulate bits
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture_id, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "Error: Incomplete framebuffer" << std::endl;
+        success = false;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Core profile needs a vertex array bound to draw, even without attributes
+    glGenVertexArrays(1, &array_obj);
+}
+
+Marquee::~Marquee()
+{
+    std::cout << "NOTE: deleting marquee framebuffer " << fbo << " and its bitmap" << std::endl;
+    state_forget_vertex_array(array_obj);
+    glDeleteVertexArrays(1, &array_obj);
+    glDeleteFramebuffers(1, &fbo);
+    state_forget_texture(texture_id);
+    glDeleteTextures(1, &texture_id);
+}
+
+bool Marquee::ready() const
+{
+    return !readback.busy();
+}
+
+void Marquee::start(const Shaders &program, uint id_texture, uint x0, uint y0, uint x1, uint y1)
+{
+    // Bind framebuffer and clear all bits
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, bitmap_width, bitmap_height);
+    const uint no_bits[] = {0, 0, 0, 0};
+    glClearBufferuiv(GL_COLOR, 0, no_bits);
+
+    // Every point sets the bit of its object, bits of the same word are merged by the logic op
+    state_set_capability(GL_DEPTH_TEST, false);
+    state_set_capability(GL_COLOR_LOGIC_OP, true);
+    glLogicOp(GL_OR);
+
+    // Draw one point per pixel of the rectangle
+    program.use();
+    state_bind_texture(0, GL_TEXTURE_2D, id_texture);
+    program.uniform_int("object_ids", 0);
+    uint left = std::min(x0, x1), bottom = std::min(y0, y1);
+    uint width = std::max(x0, x1) - left + 1, height = std::max(y0, y1) - bottom + 1;
+    program.uniform_int("rect_x", left);
+    program.uniform_int("rect_y", bottom);
+    program.uniform_int("rect_width", width);
+    program.uniform_int("bitmap_width", bitmap_width);
+    program.uniform_int("bitmap_height", bitmap_height);
+    state_bind_vertex_array(array_obj);
+    glDrawArrays(GL_POINTS, 0, width * height);
+
+    // Start reading back the bitmap
+    readback.start(0, 0, bitmap_width, bitmap_height);
+
+    // Restore state and bind default framebuffer
+    state_set_capability(GL_COLOR_LOGIC_OP, false);
+    state_set_capability(GL_DEPTH_TEST, true);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, window_width, window_height);
+}
+
+bool Marquee::poll(std::vector<uint> &object_ids)
+{
+    const uint *words;
+    if (!readback.poll(words))
+    {
+        return false;
+    }
+
+    // Turn set bits back into object IDs
+    object_ids.clear();
+    uint num_words = bitmap_width * bitmap_height;
+    for (uint i = 0; words && i < num_words; i++)
+    {
+        for (uint bits = words[i]; bits; bits &= bits - 1)
+        {
+            object_ids.push_back(i * 32 + __builtin_ctz(bits));
+        }
+    }
+    readback.unmap();
+    return true;
+}
@@ -1,13 +1,56 @@
 #include <iostream>
 #include <cstddef> // for offsetof
+#include <cmath>
+#include <algorithm>
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 #include "mesh.h"
+#include "hash.h"
+#include "glstate.h"
+#include "framestats.h"
 
-Mesh::Mesh(const std::vector<Vertex> &vertices, 
-            const std::vector<uint> &indices,
-            const std::vector<TextureHandle> &textures) : 
-    num_indices(indices.size()), textures(textures)
+// Sampler names of the material struct in the fragment shader, hashed at compile time
+const Uniform DIFFUSE_MAPS[] = {"material.diffuse_map1", "material.diffuse_map2", "material.diffuse_map3"};
+const Uniform SPECULAR_MAPS[] = {"material.specular_map1", "material.specular_map2", "material.specular_map3"};
+const int MAX_TEXTURES_PER_TYPE = 3;
+
+// First attribute location of the instance matrices, must match vertex.glsl
+const uint INSTANCE_M_LOCATION = 3;
+const uint INSTANCE_M_FOR_NORMALS_LOCATION = 7;
+const uint INSTANCE_OBJECT_ID_LOCATION = 10;
+
+Bounds compute_bounds(const Vertex *vertices, size_t num_vertices)
+{
+    Bounds bounds = {glm::vec3(0.f), glm::vec3(0.f), glm::vec3(0.f), 0.f};
+    if (num_vertices == 0)
+    {
+        return bounds;
+    }
+
+    // Box first, then the sphere around its center that reaches the farthest vertex
+    bounds.min = bounds.max = vertices[0].position;
+    for (size_t i = 1; i < num_vertices; i++)
+    {
+        bounds.min = glm::min(bounds.min, vertices[i].position);
+        bounds.max = glm::max(bounds.max, vertices[i].position);
+    }
+    bounds.center = (bounds.min + bounds.max) * .5f;
+    float max_distance2 = 0.f;
+    for (size_t i = 0; i < num_vertices; i++)
+    {
+        glm::vec3 offset = vertices[i].position - bounds.center;
+        max_distance2 = std::max(max_distance2, glm::dot(offset, offset));
+    }
+    bounds.radius = std::sqrt(max_distance2);
+    return bounds;
+}
+
+Mesh::Mesh(const Vertex *vertices, size_t num_vertices,
+            const uint *indices, size_t num_indices,
+            const std::vector<TextureHandle> &textures, const Bounds &bounds) : 
+    gpu_bytes(num_vertices * sizeof(Vertex) + num_indices * sizeof(uint)), bounds(bounds),
+    texture_set(hash_bytes(textures.data(), textures.size() * sizeof(TextureHandle))),
+    num_indices(num_indices), textures(textures)
 {
     // Create buffers on GPU
     glGenBuffers(1, &vbuf);
@@ -15,11 +58,11 @@ Mesh::Mesh(const std::vector<Vertex> &vertices,
     glGenVertexArrays(1, &array_obj);
 
     // Copy vertices to GPU
-    glBindVertexArray(array_obj);
+    state_bind_vertex_array(array_obj);
     glBindBuffer(GL_ARRAY_BUFFER, vbuf);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size()*sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, num_vertices*sizeof(Vertex), vertices, GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuf);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size()*sizeof(uint), indices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, num_indices*sizeof(uint), indices, GL_STATIC_DRAW);
     
     // Set vertex attribute: position
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
@@ -32,41 +75,123 @@ Mesh::Mesh(const std::vector<Vertex> &vertices,
     // Set vertex attribute: texture coordinates
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, texture_coord)));
     glEnableVertexAttribArray(2);
+    track_gpu_memory(GPU_MEMORY_MESHES, gpu_bytes);
 }
 
 Mesh::~Mesh()
 {
     std::cout << "NOTE: deleting mesh, VAO " << array_obj << std::endl;
+    track_gpu_memory(GPU_MEMORY_MESHES, -(int64_t)gpu_bytes);
+    state_forget_vertex_array(array_obj);
     glDeleteVertexArrays(1, &array_obj);
     glDeleteBuffers(1, &ibuf);
     glDeleteBuffers(1, &vbuf);
 }
 
-void Mesh::draw(const Shaders &program, bool with_textures) const
+void Mesh::bind_textures(const Shaders &program) const
 {
-    // Activate and bind textures
-    if (with_textures)
+    int diffuse_index = 0;
+    int specular_index = 0;
+    for (const TextureHandle &t : textures)
     {
-        int diffuse_index = 0;
-        int specular_index = 0;
-        for (const TextureHandle &t : textures)
+        int unit_id = diffuse_index + specular_index + 5;
+        state_bind_texture(unit_id, GL_TEXTURE_2D, t.id);
+        if (t.type == TextureType::Diffuse)
         {
-            int unit_id = diffuse_index + specular_index + 5;
-            glActiveTexture(GL_TEXTURE0 + unit_id);
-            glBindTexture(GL_TEXTURE_2D, t.id);
-            if (t.type == TextureType::Diffuse)
+            if (diffuse_index < MAX_TEXTURES_PER_TYPE)
             {
-                program.uniform_int("material.diffuse_map" + std::to_string(++diffuse_index), unit_id);
+                program.uniform_int(DIFFUSE_MAPS[diffuse_index++], unit_id);
             }
-            else
+        }
+        else
+        {
+            if (specular_index < MAX_TEXTURES_PER_TYPE)
             {
-                program.uniform_int("material.specular_map" + std::to_string(++specular_index), unit_id);
+                program.uniform_int(SPECULAR_MAPS[specular_index++], unit_id);
             }
         }
-        program.uniform_float("material.shininess", .5f);
+    }
+    program.uniform_float("material.shininess", .5f);
+}
+
+void Mesh::draw(const Shaders &program, bool with_textures) const
+{
+    // Activate and bind textures
+    if (with_textures)
+    {
+        bind_textures(program);
     }
 
     // Bind mesh and issue draw call
-    glBindVertexArray(array_obj);
+    state_bind_vertex_array(array_obj);
     glDrawElements(GL_TRIANGLES, num_indices, GL_UNSIGNED_INT, 0);
-}
\ No newline at end of file
+}
+
+void Mesh::attach_instances(uint instance_buffer) const
+{
+    state_bind_vertex_array(array_obj);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+
+    // Set instance attribute: model matrix, one column per location
+    for (uint column = 0; column < 4; column++)
+    {
+        uint location = INSTANCE_M_LOCATION + column;
+        size_t offset = offsetof(InstanceData, m) + column * sizeof(glm::vec4);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offset);
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+
+    // Set instance attribute: normal matrix, one column per location
+    for (uint column = 0; column < 3; column++)
+    {
+        uint location = INSTANCE_M_FOR_NORMALS_LOCATION + column;
+        size_t offset = offsetof(InstanceData, m_for_normals) + column * sizeof(glm::vec3);
+        glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offset);
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+
+    // Set instance attribute: object ID, as an integer
+    size_t offset = offsetof(InstanceData, object_id);
+    glVertexAttribIPointer(INSTANCE_OBJECT_ID_LOCATION, 1, GL_UNSIGNED_INT, sizeof(InstanceData), (void*)offset);
+    glEnableVertexAttribArray(INSTANCE_OBJECT_ID_LOCATION);
+    glVertexAttribDivisor(INSTANCE_OBJECT_ID_LOCATION, 1);
+}
+
+void Mesh::draw_instanced(const Shaders &program, bool with_textures, size_t num_instances) const
+{
+    // Activate and bind textures
+    if (with_textures)
+    {
+        bind_textures(program);
+    }
+
+    // Bind mesh and issue one draw call for all instances
+    bind_vertices();
+    draw_elements(num_instances);
+}
+
+void Mesh::bind_vertices() const
+{
+    state_bind_vertex_array(array_obj);
+}
+
+void Mesh::draw_elements(size_t num_instances) const
+{
+    glDrawElementsInstanced(GL_TRIANGLES, num_indices, GL_UNSIGNED_INT, 0, num_instances);
+}
+
+uint Mesh::vertex_array() const
+{
+    return array_obj;
+}
+
+bool Mesh::has_specular_map() const
+{
+    for (const TextureHandle &t : textures)
+    {
+        if (t.type == TextureType::Specular) return true;
+    }
+    return false;
+}
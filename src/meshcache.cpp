@@ -0,0 +1,289 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cstddef> // for offsetof
+#include "hash.h"
+#include "meshcache.h"
+
+namespace fs = std::filesystem;
+
+// Cached vertices are handed to glBufferData as-is, so their layout must match the attribute pointers in Mesh
+static_assert(sizeof(Vertex) == 8 * sizeof(float), "Vertex must be tightly packed to be cached");
+static_assert(sizeof(Bounds) == 10 * sizeof(float), "Bounds must be tightly packed to be cached");
+
+// File layout (native endianness, every section 4-byte aligned):
+//   CacheHeader
+//   for each material library: CacheSource, path characters, padding
+//   for each mesh:
+//     CacheMeshHeader
+//     for each texture: uint32 type, uint32 path length, path characters, padding
+//     Vertex[num_vertices]
+//     uint[num_indices]
+struct CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t num_meshes;
+    int64_t source_mtime;
+    uint64_t source_size;
+    uint64_t source_hash;
+    uint32_t num_materials;
+    uint32_t padding;
+};
+
+// A material library the model file depends on, validated like the model file itself
+struct CacheSource
+{
+    int64_t mtime;
+    uint64_t size;
+    uint64_t hash;
+    uint32_t path_length;
+    uint32_t padding;
+};
+
+struct CacheMeshHeader
+{
+    uint32_t num_vertices;
+    uint32_t num_indices;
+    uint32_t num_textures;
+    uint32_t padding;
+    Bounds bounds;
+};
+
+const char CACHE_MAGIC[8] = "PGLMESH";
+
+// Recorded size of a source file that did not exist, no real file has it
+const uint64_t MISSING_SIZE = ~0ull;
+
+std::string cache_path_of(const std::string &model_path)
+{
+    // Flatten the model path into a single file name inside the cache directory
+    std::string name = model_path;
+    for (char &c : name)
+    {
+        if (c == '/' || c == '\\') c = '_';
+    }
+    return MESH_CACHE_DIRECTORY + name + ".bin";
+}
+
+bool stat_source(const std::string &source_path, int64_t &mtime, uint64_t &size)
+{
+    std::error_code err;
+    fs::file_time_type write_time = fs::last_write_time(source_path, err);
+    if (err) return false;
+    uintmax_t file_size = fs::file_size(source_path, err);
+    if (err) return false;
+    mtime = write_time.time_since_epoch().count();
+    size = file_size;
+    return true;
+}
+
+bool hash_source(const std::string &source_path, uint64_t &hash)
+{
+    MappedFile source(source_path);
+    if (!source.is_open()) return false;
+    hash = hash_bytes(source.data, source.size);
+    return true;
+}
+
+// Check a source file against what was recorded when the cache was written.
+// The timestamp alone may change without an edit (e.g. a fresh checkout), so fall back to
+// comparing contents before giving up on the cache, and then record the new timestamp at mtime_offset.
+bool source_unchanged(const std::string &source_path, int64_t recorded_mtime, uint64_t recorded_size, uint64_t recorded_hash,
+                      const std::string &cache_path, size_t mtime_offset)
+{
+    int64_t mtime;
+    uint64_t size;
+    if (!stat_source(source_path, mtime, size))
+    {
+        // Still unchanged if it was already missing when the cache was written
+        return recorded_size == MISSING_SIZE;
+    }
+    if (size != recorded_size) return false;
+    if (mtime != recorded_mtime)
+    {
+        uint64_t hash;
+        if (!hash_source(source_path, hash) || hash != recorded_hash) return false;
+        std::fstream cache_file(cache_path, std::ios::in | std::ios::out | std::ios::binary);
+        cache_file.seekp(mtime_offset);
+        cache_file.write(reinterpret_cast<const char *>(&mtime), sizeof(mtime));
+    }
+    return true;
+}
+
+// Material libraries named by "mtllib" lines of a Wavefront file, relative to the model's directory.
+// Other formats have none, their materials are part of the model file.
+std::vector<std::string> material_libraries(const std::string &model_path)
+{
+    std::vector<std::string> paths;
+    MappedFile source(model_path);
+    if (!source.is_open()) return paths;
+    fs::path directory = fs::path(model_path).parent_path();
+    const char *text = reinterpret_cast<const char *>(source.data);
+    const char *end = text + source.size;
+    while (text < end)
+    {
+        const char *line_end = static_cast<const char *>(std::memchr(text, '\n', end - text));
+        if (!line_end) line_end = end;
+        std::string line(text, line_end);
+        text = line_end < end ? line_end + 1 : end;
+
+        // Like assimp, take the rest of the line as a single file name
+        if (line.compare(0, 7, "mtllib ") != 0) continue;
+        size_t first = line.find_first_not_of(" \t", 7);
+        size_t last = line.find_last_not_of(" \t\r");
+        if (first == std::string::npos) continue;
+        paths.push_back((directory / line.substr(first, last - first + 1)).string());
+    }
+    return paths;
+}
+
+// Bounds-checked sequential reader over the mapped cache file
+bool read_bytes(const MappedFile &file, size_t &offset, void *out, size_t count)
+{
+    if (count > file.size || offset > file.size - count) return false;
+    std::memcpy(out, file.data + offset, count);
+    offset += count;
+    return true;
+}
+
+size_t align4(size_t offset)
+{
+    return (offset + 3) & ~size_t(3);
+}
+
+bool load_mesh_cache(const std::string &model_path, ModelData &data)
+{
+    std::string cache_path = cache_path_of(model_path);
+    std::unique_ptr<MappedFile> mapping = std::make_unique<MappedFile>(cache_path);
+    if (!mapping->is_open()) return false;
+
+    // Validate header against the current source file, then its material libraries
+    size_t offset = 0;
+    CacheHeader header;
+    if (!read_bytes(*mapping, offset, &header, sizeof(header))) return false;
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) return false;
+    if (header.version != MESH_CACHE_VERSION) return false;
+    if (!source_unchanged(model_path, header.source_mtime, header.source_size, header.source_hash,
+                          cache_path, offsetof(CacheHeader, source_mtime))) return false;
+    for (uint32_t i = 0; i < header.num_materials; i++)
+    {
+        size_t source_offset = offset;
+        CacheSource source;
+        if (!read_bytes(*mapping, offset, &source, sizeof(source))) return false;
+        std::string path(source.path_length, '\0');
+        if (!read_bytes(*mapping, offset, path.data(), source.path_length)) return false;
+        offset = align4(offset);
+        if (!source_unchanged(path, source.mtime, source.size, source.hash,
+                              cache_path, source_offset + offsetof(CacheSource, mtime))) return false;
+    }
+
+    // Point meshes straight into the mapping
+    std::vector<MeshData> meshes(header.num_meshes);
+    for (MeshData &mesh : meshes)
+    {
+        CacheMeshHeader mesh_header;
+        if (!read_bytes(*mapping, offset, &mesh_header, sizeof(mesh_header))) return false;
+        for (uint32_t i = 0; i < mesh_header.num_textures; i++)
+        {
+            uint32_t type, length;
+            if (!read_bytes(*mapping, offset, &type, sizeof(type))) return false;
+            if (!read_bytes(*mapping, offset, &length, sizeof(length))) return false;
+            if (type != static_cast<uint32_t>(TextureType::Diffuse) && type != static_cast<uint32_t>(TextureType::Specular)) return false;
+            std::string path(length, '\0');
+            if (!read_bytes(*mapping, offset, path.data(), length)) return false;
+            offset = align4(offset);
+            mesh.textures.emplace_back(TextureRef{path, static_cast<TextureType>(type)});
+        }
+
+        size_t vertex_bytes = mesh_header.num_vertices * sizeof(Vertex);
+        size_t index_bytes = mesh_header.num_indices * sizeof(uint);
+        if (offset + vertex_bytes + index_bytes > mapping->size) return false;
+        mesh.vertices = reinterpret_cast<const Vertex *>(mapping->data + offset);
+        mesh.num_vertices = mesh_header.num_vertices;
+        offset += vertex_bytes;
+        mesh.indices = reinterpret_cast<const uint *>(mapping->data + offset);
+        mesh.num_indices = mesh_header.num_indices;
+        mesh.bounds = mesh_header.bounds;
+        offset += index_bytes;
+    }
+
+    data.meshes = std::move(meshes);
+    data.mapping = std::move(mapping);
+    data.from_cache = true;
+    return true;
+}
+
+void write_padding(std::ofstream &out)
+{
+    const char zeros[4] = {0, 0, 0, 0};
+    out.write(zeros, align4(out.tellp()) - out.tellp());
+}
+
+bool save_mesh_cache(const std::string &model_path, const ModelData &data)
+{
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = MESH_CACHE_VERSION;
+    header.num_meshes = data.meshes.size();
+    if (!stat_source(model_path, header.source_mtime, header.source_size)) return false;
+    if (!hash_source(model_path, header.source_hash)) return false;
+    std::vector<std::string> materials = material_libraries(model_path);
+    header.num_materials = materials.size();
+    header.padding = 0;
+
+    // Write to a temporary file first so that an interrupted write never leaves a corrupt cache behind
+    std::error_code err;
+    fs::create_directories(MESH_CACHE_DIRECTORY, err);
+    std::string cache_path = cache_path_of(model_path);
+    std::string temp_path = cache_path + ".tmp";
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "Error: cannot write mesh cache " << temp_path << std::endl;
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const std::string &path : materials)
+    {
+        // A missing library is recorded too, so that the cache goes stale once it appears
+        CacheSource source = {0, MISSING_SIZE, 0, static_cast<uint32_t>(path.size()), 0};
+        if (stat_source(path, source.mtime, source.size)) hash_source(path, source.hash);
+        out.write(reinterpret_cast<const char *>(&source), sizeof(source));
+        out.write(path.data(), path.size());
+        write_padding(out);
+    }
+    for (const MeshData &mesh : data.meshes)
+    {
+        CacheMeshHeader mesh_header = {
+            static_cast<uint32_t>(mesh.num_vertices),
+            static_cast<uint32_t>(mesh.num_indices),
+            static_cast<uint32_t>(mesh.textures.size()),
+            0,
+            mesh.bounds};
+        out.write(reinterpret_cast<const char *>(&mesh_header), sizeof(mesh_header));
+        for (const TextureRef &texture : mesh.textures)
+        {
+            uint32_t type = static_cast<uint32_t>(texture.type);
+            uint32_t length = texture.path.size();
+            out.write(reinterpret_cast<const char *>(&type), sizeof(type));
+            out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+            out.write(texture.path.data(), length);
+            write_padding(out);
+        }
+        out.write(reinterpret_cast<const char *>(mesh.vertices), mesh.num_vertices * sizeof(Vertex));
+        out.write(reinterpret_cast<const char *>(mesh.indices), mesh.num_indices * sizeof(uint));
+    }
+    out.close();
+    if (!out)
+    {
+        std::cout << "Error: failed writing mesh cache " << temp_path << std::endl;
+        fs::remove(temp_path, err);
+        return false;
+    }
+
+    fs::rename(temp_path, cache_path, err);
+    return !err;
+}
@@ -1,145 +1,19 @@
 #include <memory>   
 #include <iostream>
-#include <assimp/Importer.hpp>
-#include <assimp/postprocess.h>
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 #include <glm/gtc/matrix_transform.hpp>
-#include "mesh.h"
 #include "model.h"
+#include "glstate.h"
+#include "profiler.h"
 
 #define PI 3.14159f
 
-Model::Model(const std::string &filepath) 
-{ 
-    Assimp::Importer importer;
-    const aiScene *scene = importer.ReadFile(filepath, aiProcess_Triangulate | aiProcess_FlipUVs);
-    if (!scene || !scene->mRootNode || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)
-    {
-        std::cout << "Error importing model: " << filepath << std::endl;
-        std::cout << importer.GetErrorString() << std::endl;
-    }
-    else
-    {
-        directory = filepath.substr(0, filepath.find_last_of('/') + 1);
-        processNode(scene->mRootNode, scene);
-    }
-    world_transform = glm::mat4(1.f); 
-    print_debug_stats(filepath);
-}
-
-void Model::print_debug_stats(const std::string &filepath)
-{
-    std::cout << "Model " << filepath << " loaded successfully with ";
-    int cnt_diffuse = 0;
-    int cnt_specular = 0;
-    for (const std::unique_ptr<Texture> &tex : texture_pool)
-    {
-        switch (tex->type)
-        {
-        case TextureType::Diffuse:
-            cnt_diffuse++;
-            break;
-        case TextureType::Specular:
-            cnt_specular++;
-            break;
-        default:
-            break;
-        }
-    }
-    std::cout << cnt_diffuse << " diffuse textures and ";
-    std::cout << cnt_specular << " specular textures" << std::endl;
-}
-
-void Model::processNode(aiNode *node, const aiScene *scene)
-{
-    // Process all meshes in this node
-    for (uint i = 0; i < node->mNumMeshes; i++)
-    {
-        processMesh(scene->mMeshes[node->mMeshes[i]], scene);
-    }
-    
-    // Recursively process this node's children
-    for (uint i = 0; i < node->mNumChildren; i++)
-    {
-        processNode(node->mChildren[i], scene);
-    }
-}
-
-void Model::processMesh(aiMesh *mesh, [[maybe_unused]] const aiScene *scene)
-{
-    // Read off vertices
-    std::vector<Vertex> vertices;
-    for (uint i = 0; i < mesh->mNumVertices; i++)
-    {
-        aiVector3D aiPosition = mesh->mVertices[i];
-        glm::vec3 position(aiPosition.x, aiPosition.y, aiPosition.z);
-
-        aiVector3D aiNormal = mesh->mNormals[i];
-        glm::vec3 normal(aiNormal.x, aiNormal.y, aiNormal.z);
-
-        aiVector3D * aiTextureCoord = mesh->mTextureCoords[0];
-        glm::vec2 texture_coord(0.f, 0.f);
-        if (aiTextureCoord)
-        {
-            texture_coord.x = aiTextureCoord[i].x;
-            texture_coord.y = aiTextureCoord[i].y;
-        }
-        vertices.push_back({position, normal, texture_coord});
-    }
-
-    // Read off indices
-    std::vector<uint> indices;
-    indices.reserve(mesh->mNumFaces * 3);
-    for (uint i = 0; i < mesh->mNumFaces; i++)
-    {
-        aiFace face = mesh->mFaces[i];
-        indices.insert(indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
-    }
-    
-    // Read off textures
-    std::vector<TextureHandle> textures;
-    if (mesh->mMaterialIndex >= 0)
-    {
-        aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
-        aiString str;
-        for (uint i = 0; i < material->GetTextureCount(aiTextureType_DIFFUSE); i++)
-        {
-            material->GetTexture(aiTextureType_DIFFUSE, i, &str);
-            std::string texture_path = directory + std::string(str.C_Str());
-            uint texture_id = lazy_add_to_pool(texture_path, TextureType::Diffuse);
-            textures.emplace_back(TextureHandle{texture_id, TextureType::Diffuse});
-        }
-        for (uint i = 0; i < material->GetTextureCount(aiTextureType_SPECULAR); i++)
-        {
-            material->GetTexture(aiTextureType_SPECULAR, i, &str);
-            std::string texture_path = directory + std::string(str.C_Str());
-            uint texture_id = lazy_add_to_pool(texture_path, TextureType::Specular);
-            textures.emplace_back(TextureHandle{texture_id, TextureType::Specular});
-        }
-    }
-
-    // Create a mesh object in-place
-    meshes.emplace_back(std::make_unique<Mesh>(vertices, indices, std::move(textures)));
-}
-
-uint Model::lazy_add_to_pool(const std::string &texture_path, TextureType type)
+Model::Model(const std::string &filepath) : 
+    world_transform(1.f), is_selected(false)
 {
-    // Check if texture already exists in pool
-    for (const std::unique_ptr<Texture> &texture : texture_pool)
-    {
-        if (texture_path == texture->filepath)
-        {
-            // Already exists, do not load again
-            return texture->id;
-        }
-    }
-    
-    // Texture needs to actually load from file
-    std::unique_ptr<Texture> newtexture = std::make_unique<Texture>(texture_path, type);
-    uint texture_id = newtexture->id;
-    texture_pool.emplace_back(std::move(newtexture));
-    return texture_id;
+    PROFILE_ZONE("Model::Model");
+    asset = ModelAsset::acquire(filepath);
 }
 
 void Model::spin(float delta_time)
@@ -164,42 +38,22 @@ void Model::rotate(float angle, float axis_x, float axis_y, float axis_z)
     world_transform = glm::rotate(world_transform, angle, glm::vec3(axis_x, axis_y, axis_z));
 }
 
-void Model::draw(const Shaders &program, bool with_textures) const
+const ModelAsset &Model::get_asset() const
+{
+    return *asset;
+}
+
+void Model::world_bounds(glm::vec3 &center, float &radius) const
+{
+    transform_sphere(asset->bounds, world_transform, center, radius);
+}
+
+void Model::draw(const Shaders &program, bool with_textures, const Frustum *frustum) const
 {
     // Set up transform uniforms
     program.use();
 
     // Draw all meshes
-    for (const std::unique_ptr<Mesh> &m : meshes)
-    {
-        m->draw(program, with_textures);
-    }
+    asset->draw(program, with_textures, frustum, world_transform);
 }
 
-
-void Model::draw_with_outline(const Shaders &program, const Shaders &outline) const
-{
-    // Write 1 to stencil buffer in every visible fragment
-    program.use();
-    glStencilMask(0xFF);
-    glStencilFunc(GL_ALWAYS, 1, 0xFF);
-    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-    
-    // Draw original model
-    draw(program, true);
-    
-    // Set drawing for only where stencil buffer is 0
-    outline.use();
-    glStencilMask(0x00);
-    glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
-    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
-    glDisable(GL_DEPTH_TEST);
-    
-    // Draw outline 
-    draw(outline, false);
-    
-    // Restore stencil behavior 
-    glStencilMask(0xFF);
-    glStencilFunc(GL_ALWAYS, 0, 0xFF);
-    glEnable(GL_DEPTH_TEST);
-}
\ No newline at end of file
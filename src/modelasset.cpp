@@ -0,0 +1,332 @@
+#include <memory>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+#include "texturecache.h"
+#include "modelasset.h"
+#include "framestats.h"
+#include "profiler.h"
+
+std::unordered_map<std::string, std::weak_ptr<ModelAsset>> ModelAsset::registry;
+
+std::shared_ptr<ModelAsset> ModelAsset::acquire(const std::string &filepath)
+{
+    // Reuse the resident asset if some placement still holds it
+    std::shared_ptr<ModelAsset> asset = registry[filepath].lock();
+    if (!asset)
+    {
+        auto start_time = std::chrono::steady_clock::now();
+        ModelData data;
+        load_data(filepath, data);
+        asset = create(filepath, data);
+        std::chrono::duration<float, std::milli> load_time = std::chrono::steady_clock::now() - start_time;
+        asset->print_debug_stats(load_time.count(), data.from_cache);
+    }
+    return asset;
+}
+
+std::shared_ptr<ModelAsset> ModelAsset::create(const std::string &filepath, const ModelData &data)
+{
+    std::shared_ptr<ModelAsset> asset = std::make_shared<ModelAsset>(filepath, data);
+    registry[filepath] = asset;
+    return asset;
+}
+
+bool ModelAsset::load_data(const std::string &filepath, ModelData &data)
+{
+    // Prefer the mesh cache, fall back to a full import which then refreshes the cache
+    auto start_time = std::chrono::steady_clock::now();
+    bool success = load_mesh_cache(filepath, data);
+    if (!success)
+    {
+        success = import(filepath, data);
+        if (success)
+        {
+            save_mesh_cache(filepath, data);
+        }
+    }
+    if (success)
+    {
+        build_bvh(data);
+    }
+    std::chrono::duration<float, std::milli> load_time = std::chrono::steady_clock::now() - start_time;
+    data.read_ms = load_time.count() - data.convert_ms;
+    return success;
+}
+
+void ModelAsset::build_bvh(ModelData &data)
+{
+    // Gather triangles of all meshes, numbered in mesh order
+    std::vector<glm::vec3> triangle_vertices;
+    for (const MeshData &mesh : data.meshes)
+    {
+        for (size_t i = 0; i + 2 < mesh.num_indices; i += 3)
+        {
+            for (size_t v = 0; v < 3; v++)
+            {
+                triangle_vertices.push_back(mesh.vertices[mesh.indices[i + v]].position);
+            }
+        }
+    }
+    data.bvh = std::make_shared<TriangleBVH>(triangle_vertices);
+}
+
+std::string ModelAsset::directory_of(const std::string &filepath)
+{
+    return filepath.substr(0, filepath.find_last_of('/') + 1);
+}
+
+void ModelAsset::print_registry_stats()
+{
+    size_t total_saved = 0;
+    for (const auto &[filepath, entry] : registry)
+    {
+        std::shared_ptr<ModelAsset> asset = entry.lock();
+        if (!asset) continue;
+
+        // Do not count the reference held by this function
+        size_t references = asset.use_count() - 1;
+        size_t saved = asset->gpu_bytes() * (references - 1);
+        total_saved += saved;
+        std::cout << "Asset " << filepath << ": " << references << " placements, ";
+        std::cout << asset->gpu_bytes() / 1024 << "KB on GPU, " << saved / 1024 << "KB saved by sharing" << std::endl;
+    }
+    std::cout << "Sharing assets saved " << total_saved / 1024 << "KB of GPU memory in total" << std::endl;
+}
+
+ModelAsset::ModelAsset(const std::string &filepath, const ModelData &data) : 
+    filepath(filepath), bounds(), bvh(data.bvh), instance_capacity(1), num_diffuse(0), num_specular(0), directory(directory_of(filepath))
+{ 
+    PROFILE_ZONE("ModelAsset::ModelAsset");
+
+    // Room for one instance, so that non-instanced draws never read attributes out of bounds
+    glGenBuffers(1, &instance_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+    glBufferData(GL_ARRAY_BUFFER, instance_capacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+    track_gpu_memory(GPU_MEMORY_MESHES, instance_capacity * sizeof(InstanceData));
+
+    // Upload meshes and load their textures
+    std::unordered_set<uint> diffuse_ids, specular_ids;
+    for (const MeshData &mesh_data : data.meshes)
+    {
+        std::vector<TextureHandle> textures;
+        for (const TextureRef &texture : mesh_data.textures)
+        {
+            uint texture_id = lazy_add_to_pool(directory + texture.path);
+            textures.emplace_back(TextureHandle{texture_id, texture.type});
+            if (texture.type == TextureType::Diffuse) diffuse_ids.insert(texture_id);
+            else specular_ids.insert(texture_id);
+        }
+        meshes.emplace_back(std::make_unique<Mesh>(mesh_data.vertices, mesh_data.num_vertices,
+                                                   mesh_data.indices, mesh_data.num_indices, textures,
+                                                   mesh_data.bounds));
+        meshes.back()->attach_instances(instance_buffer);
+        bounds = (meshes.size() == 1) ? mesh_data.bounds : merge_bounds(bounds, mesh_data.bounds);
+    }
+    num_diffuse = diffuse_ids.size();
+    num_specular = specular_ids.size();
+}
+
+ModelAsset::~ModelAsset()
+{
+    std::cout << "NOTE: deleting model asset " << filepath << ", instance buffer " << instance_buffer << std::endl;
+    track_gpu_memory(GPU_MEMORY_MESHES, -(int64_t)(instance_capacity * sizeof(InstanceData)));
+    glDeleteBuffers(1, &instance_buffer);
+}
+
+bool ModelAsset::import(const std::string &filepath, ModelData &data)
+{
+    Assimp::Importer importer;
+    const aiScene *scene = importer.ReadFile(filepath, aiProcess_Triangulate | aiProcess_FlipUVs);
+    if (!scene || !scene->mRootNode || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)
+    {
+        std::cout << "Error importing model: " << filepath << std::endl;
+        std::cout << importer.GetErrorString() << std::endl;
+        return false;
+    }
+
+    // Time the conversion into our own vertex format separately from parsing
+    auto start_time = std::chrono::steady_clock::now();
+    processNode(scene->mRootNode, scene, data);
+    std::chrono::duration<float, std::milli> convert_time = std::chrono::steady_clock::now() - start_time;
+    data.convert_ms = convert_time.count();
+    return true;
+}
+
+void ModelAsset::print_debug_stats(float load_ms, bool from_cache) const
+{
+    std::cout << "Model " << filepath << " loaded successfully in " << load_ms << "ms ";
+    std::cout << (from_cache ? "(from mesh cache)" : "(imported with assimp)") << " with ";
+    std::cout << num_diffuse << " diffuse textures and ";
+    std::cout << num_specular << " specular textures" << std::endl;
+}
+
+void ModelAsset::processNode(aiNode *node, const aiScene *scene, ModelData &data)
+{
+    // Process all meshes in this node
+    for (uint i = 0; i < node->mNumMeshes; i++)
+    {
+        processMesh(scene->mMeshes[node->mMeshes[i]], scene, data);
+    }
+    
+    // Recursively process this node's children
+    for (uint i = 0; i < node->mNumChildren; i++)
+    {
+        processNode(node->mChildren[i], scene, data);
+    }
+}
+
+void ModelAsset::processMesh(aiMesh *mesh, [[maybe_unused]] const aiScene *scene, ModelData &data)
+{
+    MeshData &mesh_data = data.meshes.emplace_back();
+
+    // Read off vertices
+    std::vector<Vertex> &vertices = mesh_data.owned_vertices;
+    vertices.reserve(mesh->mNumVertices);
+    for (uint i = 0; i < mesh->mNumVertices; i++)
+    {
+        aiVector3D aiPosition = mesh->mVertices[i];
+        glm::vec3 position(aiPosition.x, aiPosition.y, aiPosition.z);
+
+        aiVector3D aiNormal = mesh->mNormals[i];
+        glm::vec3 normal(aiNormal.x, aiNormal.y, aiNormal.z);
+
+        aiVector3D * aiTextureCoord = mesh->mTextureCoords[0];
+        glm::vec2 texture_coord(0.f, 0.f);
+        if (aiTextureCoord)
+        {
+            texture_coord.x = aiTextureCoord[i].x;
+            texture_coord.y = aiTextureCoord[i].y;
+        }
+        vertices.push_back({position, normal, texture_coord});
+    }
+
+    // Read off indices
+    std::vector<uint> &indices = mesh_data.owned_indices;
+    indices.reserve(mesh->mNumFaces * 3);
+    for (uint i = 0; i < mesh->mNumFaces; i++)
+    {
+        aiFace face = mesh->mFaces[i];
+        indices.insert(indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
+    }
+
+    // Point the mesh views at the owned storage
+    mesh_data.vertices = vertices.data();
+    mesh_data.num_vertices = vertices.size();
+    mesh_data.indices = indices.data();
+    mesh_data.num_indices = indices.size();
+
+    // Bounding volumes for culling, computed once here and stored in the mesh cache
+    mesh_data.bounds = compute_bounds(mesh_data.vertices, mesh_data.num_vertices);
+    
+    // Read off texture paths (relative to the model directory)
+    if (mesh->mMaterialIndex >= 0)
+    {
+        aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
+        aiString str;
+        for (uint i = 0; i < material->GetTextureCount(aiTextureType_DIFFUSE); i++)
+        {
+            material->GetTexture(aiTextureType_DIFFUSE, i, &str);
+            mesh_data.textures.emplace_back(TextureRef{std::string(str.C_Str()), TextureType::Diffuse});
+        }
+        for (uint i = 0; i < material->GetTextureCount(aiTextureType_SPECULAR); i++)
+        {
+            material->GetTexture(aiTextureType_SPECULAR, i, &str);
+            mesh_data.textures.emplace_back(TextureRef{std::string(str.C_Str()), TextureType::Specular});
+        }
+    }
+}
+
+uint ModelAsset::lazy_add_to_pool(const std::string &texture_path)
+{
+    std::shared_ptr<Texture> texture = TextureCache::get(texture_path);
+    texture_pool.insert(texture);
+    return texture->id;
+}
+
+size_t ModelAsset::gpu_bytes() const
+{
+    size_t bytes = 0;
+    for (const std::unique_ptr<Mesh> &m : meshes)
+    {
+        bytes += m->gpu_bytes;
+    }
+    for (const std::shared_ptr<Texture> &texture : texture_pool)
+    {
+        bytes += texture->gpu_bytes;
+    }
+    return bytes;
+}
+
+// Whether a mesh placed by transform is at least partially inside the frustum
+bool mesh_visible(const Mesh &mesh, const Frustum &frustum, const glm::mat4 &transform)
+{
+    glm::vec3 center;
+    float radius;
+    transform_sphere(mesh.bounds, transform, center, radius);
+    return frustum.intersects(center, radius);
+}
+
+void ModelAsset::draw(const Shaders &program, bool with_textures, const Frustum *frustum, const glm::mat4 &transform) const
+{
+    // Draw all meshes
+    for (const std::unique_ptr<Mesh> &m : meshes)
+    {
+        // A single mesh has the bounds of the whole asset, which the caller has tested already
+        if (frustum && meshes.size() > 1 && !mesh_visible(*m, *frustum, transform))
+        {
+            continue;
+        }
+        m->draw(program, with_textures);
+    }
+}
+
+void ModelAsset::queue_instanced(RenderQueue &queue, const Shaders &program, bool with_textures,
+                                 const std::vector<InstanceData> &instances, const Frustum *frustum, glm::vec3 eye,
+                                 const Shaders *program_without_specular) const
+{
+    if (instances.empty())
+    {
+        return;
+    }
+
+    // Queue instance data for upload at submit, growing the buffer only when it is too small
+    if (instances.size() > instance_capacity)
+    {
+        track_gpu_memory(GPU_MEMORY_MESHES, (instances.size() - instance_capacity) * sizeof(InstanceData));
+        instance_capacity = instances.size();
+    }
+    uint upload = queue.add_instances(instance_buffer, instances, instance_capacity);
+
+    // Queue all meshes
+    for (const std::unique_ptr<Mesh> &m : meshes)
+    {
+        // A single mesh has the bounds of the whole asset, which the caller has tested already
+        bool test_visibility = frustum && meshes.size() > 1;
+        bool visible = !test_visibility;
+        float nearest = RenderQueue::MAX_DEPTH;
+        for (const InstanceData &instance : instances)
+        {
+            glm::vec3 center;
+            float radius;
+            transform_sphere(m->bounds, instance.m, center, radius);
+            if (test_visibility && frustum->intersects(center, radius))
+            {
+                visible = true;
+            }
+            nearest = std::min(nearest, glm::length(center - eye) - radius);
+        }
+        if (!visible)
+        {
+            frame_stats.meshes_culled++;
+            continue;
+        }
+        bool use_without_specular = program_without_specular && !m->has_specular_map();
+        queue.push(use_without_specular ? *program_without_specular : program, *m, upload, with_textures, nearest,
+                   filepath.c_str());
+    }
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <algorithm>
+#include <glad/gl.h>
+#include "outline.h"
+#include "glstate.h"
+
+Outline::Outline() : has_selected(false)
+{
+    // Core profile needs a vertex array bound to draw, even without attributes
+    glGenVertexArrays(1, &array_obj);
+
+    // Create buffer texture of selection flags, with room for "no object" only until set_selected
+    selected.assign(1, 0);
+    glGenBuffers(1, &selected_buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, selected_buffer);
+    glBufferData(GL_TEXTURE_BUFFER, selected.size(), selected.data(), GL_DYNAMIC_DRAW);
+    glGenTextures(1, &selected_texture);
+    state_bind_texture(1, GL_TEXTURE_BUFFER, selected_texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R8UI, selected_buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+Outline::~Outline()
+{
+    std::cout << "NOTE: deleting outline, VAO " << array_obj << std::endl;
+    state_forget_vertex_array(array_obj);
+    glDeleteVertexArrays(1, &array_obj);
+    state_forget_texture(selected_texture);
+    glDeleteTextures(1, &selected_texture);
+    glDeleteBuffers(1, &selected_buffer);
+}
+
+void Outline::set_selected(const std::vector<uint8_t> &new_selected)
+{
+    if (new_selected == selected)
+    {
+        return;
+    }
+    selected = new_selected;
+    has_selected = std::find(selected.begin(), selected.end(), 1) != selected.end();
+
+    // Orphan the old storage, so that a draw still reading it does not stall the upload
+    glBindBuffer(GL_TEXTURE_BUFFER, selected_buffer);
+    glBufferData(GL_TEXTURE_BUFFER, selected.size(), selected.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+bool Outline::any_selected() const
+{
+    return has_selected;
+}
+
+void Outline::draw(const Shaders &program, uint id_texture, glm::vec3 color) const
+{
+    // Cover every pixel regardless of what was drawn before
+    state_set_capability(GL_DEPTH_TEST, false);
+    state_polygon_mode(GL_FILL);
+
+    // Bind object IDs and selection flags
+    program.use();
+    state_bind_texture(0, GL_TEXTURE_2D, id_texture);
+    state_bind_texture(1, GL_TEXTURE_BUFFER, selected_texture);
+    program.uniform_int("object_ids", 0);
+    program.uniform_int("selected", 1);
+    program.uniform_vec3("color", color);
+
+    // One triangle covering the screen
+    state_bind_vertex_array(array_obj);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // Restore depth test
+    state_set_capability(GL_DEPTH_TEST, true);
+}
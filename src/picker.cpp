@@ -0,0 +1,45 @@
+#include <limits>
+#include "picker.h"
+
+void RayPicker::build(const std::vector<std::unique_ptr<Model>> &scene)
+{
+    refit(scene);
+    hierarchy.build(world_boxes);
+}
+
+void RayPicker::refit(const std::vector<std::unique_ptr<Model>> &scene)
+{
+    placements.resize(scene.size());
+    world_boxes.resize(scene.size());
+    for (size_t i = 0; i < scene.size(); i++)
+    {
+        const TriangleBVH *bvh = scene[i]->get_asset().bvh.get();
+        placements[i] = Placement{bvh, glm::inverse(scene[i]->world_transform)};
+        world_boxes[i] = bvh ? bvh->bounds().transformed(scene[i]->world_transform) : Box::empty();
+    }
+    hierarchy.refit(world_boxes);
+}
+
+bool RayPicker::cast(const Ray &ray, RayHit &hit) const
+{
+    bool found = false;
+    float max_distance = std::numeric_limits<float>::infinity();
+    hierarchy.intersect(ray, max_distance, [&](uint object, float &nearest)
+    {
+        const Placement &placement = placements[object];
+        if (!placement.bvh) return;
+
+        // Without normalizing the direction, distances in model space equal those in world space
+        Ray local_ray{glm::vec3(placement.world_to_model * glm::vec4(ray.origin, 1.f)),
+                      glm::vec3(placement.world_to_model * glm::vec4(ray.direction, 0.f))};
+        uint triangle;
+        float distance;
+        if (placement.bvh->intersect(local_ray, nearest, triangle, distance))
+        {
+            nearest = distance;
+            hit = RayHit{object, triangle, distance};
+            found = true;
+        }
+    });
+    return found;
+}
@@ -0,0 +1,159 @@
+#include <iostream>
+#include <fstream>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include "profiler.h"
+
+// Fields are relaxed atomics so that exporting while the owner thread writes is well defined.
+// They compile to plain loads and stores.
+struct ProfileEvent
+{
+    std::atomic<const char*> name;
+    std::atomic<uint64_t> start_ns;
+    std::atomic<uint64_t> end_ns;
+};
+
+// Ring buffer written only by its thread
+struct ThreadEvents
+{
+    uint id;
+    std::string name;
+    std::atomic<uint64_t> num_written{0};
+    ProfileEvent events[PROFILER_EVENTS_PER_THREAD];
+};
+
+// Buffers of all threads that ever recorded, kept after threads exit so their zones can still be exported.
+// The mutex guards only registration, names and the list itself, never recording.
+std::mutex threads_mutex;
+std::vector<std::unique_ptr<ThreadEvents>> threads;
+thread_local ThreadEvents *this_thread_events = nullptr;
+
+ProfilerTrack *profiler_add_track(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(threads_mutex);
+    threads.push_back(std::make_unique<ThreadEvents>());
+    ThreadEvents *track = threads.back().get();
+    track->id = threads.size();
+    track->name = name.empty() ? "thread " + std::to_string(track->id) : name;
+    return track;
+}
+
+ThreadEvents &thread_events()
+{
+    if (!this_thread_events)
+    {
+        this_thread_events = profiler_add_track("");
+    }
+    return *this_thread_events;
+}
+
+void profiler_record(const char *name, uint64_t start_ns, uint64_t end_ns)
+{
+    profiler_record(&thread_events(), name, start_ns, end_ns);
+}
+
+void profiler_record(ProfilerTrack *track, const char *name, uint64_t start_ns, uint64_t end_ns)
+{
+    ThreadEvents &thread = *track;
+    uint64_t index = thread.num_written.load(std::memory_order_relaxed);
+    ProfileEvent &event = thread.events[index % PROFILER_EVENTS_PER_THREAD];
+    event.name.store(name, std::memory_order_relaxed);
+    event.start_ns.store(start_ns, std::memory_order_relaxed);
+    event.end_ns.store(end_ns, std::memory_order_relaxed);
+    thread.num_written.store(index + 1, std::memory_order_release);
+}
+
+void profiler_set_thread_name(const std::string &name)
+{
+    ThreadEvents &thread = thread_events();
+    std::lock_guard<std::mutex> lock(threads_mutex);
+    thread.name = name;
+}
+
+struct CopiedEvent
+{
+    const char *name;
+    uint64_t start_ns, end_ns;
+    uint thread_id;
+};
+
+// Copy the events of one thread that were complete during the copy, the owner may overwrite the oldest meanwhile
+void copy_events(const ThreadEvents &thread, std::vector<CopiedEvent> &copied)
+{
+    const uint64_t capacity = PROFILER_EVENTS_PER_THREAD;
+    uint64_t end = thread.num_written.load(std::memory_order_acquire);
+    uint64_t begin = end > capacity ? end - capacity : 0;
+    size_t first_copied = copied.size();
+    for (uint64_t i = begin; i < end; i++)
+    {
+        const ProfileEvent &event = thread.events[i % capacity];
+        copied.push_back({event.name.load(std::memory_order_relaxed), event.start_ns.load(std::memory_order_relaxed),
+                          event.end_ns.load(std::memory_order_relaxed), thread.id});
+    }
+
+    // Drop slots the owner reached while copying, including the one it may be writing now
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t now_written = thread.num_written.load(std::memory_order_relaxed) + 1;
+    if (now_written > capacity && now_written - capacity > begin)
+    {
+        uint64_t num_torn = std::min(now_written - capacity, end) - begin;
+        copied.erase(copied.begin() + first_copied, copied.begin() + first_copied + num_torn);
+    }
+}
+
+bool profiler_export(const std::string &filepath)
+{
+    std::vector<CopiedEvent> copied;
+    std::vector<std::pair<uint, std::string>> thread_names;
+    {
+        std::lock_guard<std::mutex> lock(threads_mutex);
+        for (const std::unique_ptr<ThreadEvents> &thread : threads)
+        {
+            copy_events(*thread, copied);
+            thread_names.emplace_back(thread->id, thread->name);
+        }
+    }
+
+    std::ofstream out(filepath, std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "Error: cannot write profiler trace " << filepath << std::endl;
+        return false;
+    }
+
+    // Timestamps in microseconds from the earliest recorded zone.
+    // Zone and thread names are identifiers from the code, so nothing needs escaping.
+    uint64_t origin_ns = UINT64_MAX;
+    for (const CopiedEvent &event : copied)
+    {
+        origin_ns = std::min(origin_ns, event.start_ns);
+    }
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << std::endl;
+    for (const std::pair<uint, std::string> &thread_name : thread_names)
+    {
+        out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread_name.first;
+        out << ", \"args\": {\"name\": \"" << thread_name.second << "\"}}," << std::endl;
+    }
+    out.precision(3);
+    out << std::fixed;
+    for (const CopiedEvent &event : copied)
+    {
+        out << "{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread_id;
+        out << ", \"ts\": " << (event.start_ns - origin_ns) / 1000.0;
+        out << ", \"dur\": " << (event.end_ns - event.start_ns) / 1000.0 << "}," << std::endl;
+    }
+    // Trailing entry so that every event above can end with a comma
+    out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"playgroundgl\"}}" << std::endl;
+    out << "]}" << std::endl;
+    out.close();
+    if (!out)
+    {
+        std::cout << "Error: failed writing profiler trace " << filepath << std::endl;
+        return false;
+    }
+    std::cout << "Profiler trace of " << copied.size() << " zones written to " << filepath << std::endl;
+    return true;
+}
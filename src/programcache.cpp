@@ -0,0 +1,142 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include <glad/gl.h>
+#include "hash.h"
+#include "mappedfile.h"
+#include "programcache.h"
+
+namespace fs = std::filesystem;
+
+// File layout (native endianness):
+//   ProgramCacheHeader
+//   binary[binary_length]
+struct ProgramCacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t binary_format;
+    uint64_t key;
+    uint32_t binary_length;
+    float build_ms;
+};
+
+const char PROGRAM_CACHE_MAGIC[8] = "PGLPROG";
+
+std::string program_cache_path_of(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return PROGRAM_CACHE_DIRECTORY + std::string(name);
+}
+
+bool program_cache_supported()
+{
+#ifdef GL_ARB_get_program_binary
+    if (!GLAD_GL_ARB_get_program_binary) return false;
+
+    // Some drivers expose the extension without any binary format
+    int num_formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+    return num_formats > 0;
+#else
+    // GLAD was generated without the extension
+    return false;
+#endif
+}
+
+uint64_t driver_hash()
+{
+    uint64_t hash = HASH_SEED;
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    {
+        const char *value = reinterpret_cast<const char *>(glGetString(name));
+        if (value) hash = hash_bytes(value, std::strlen(value), hash);
+    }
+    return hash;
+}
+
+#ifdef GL_ARB_get_program_binary
+
+bool load_program_cache(uint program, uint64_t key, float &build_ms)
+{
+    MappedFile file(program_cache_path_of(key));
+    if (!file.is_open()) return false;
+
+    // Validate header, the key guards against hash collisions in the file name only
+    ProgramCacheHeader header;
+    if (file.size < sizeof(header)) return false;
+    std::memcpy(&header, file.data, sizeof(header));
+    if (std::memcmp(header.magic, PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC)) != 0) return false;
+    if (header.version != PROGRAM_CACHE_VERSION) return false;
+    if (header.key != key) return false;
+    if (header.binary_length > file.size - sizeof(header)) return false;
+
+    // The driver may still refuse the binary, which shows up as a failed link
+    int linking_success;
+    glProgramBinary(program, header.binary_format, file.data + sizeof(header), header.binary_length);
+    glGetProgramiv(program, GL_LINK_STATUS, &linking_success);
+    if (!linking_success) return false;
+    build_ms = header.build_ms;
+    return true;
+}
+
+bool save_program_cache(uint program, uint64_t key, float build_ms)
+{
+    int binary_length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+    if (binary_length <= 0) return false;
+    std::vector<char> binary(binary_length);
+    GLenum binary_format;
+    glGetProgramBinary(program, binary_length, nullptr, &binary_format, binary.data());
+
+    ProgramCacheHeader header;
+    std::memcpy(header.magic, PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC));
+    header.version = PROGRAM_CACHE_VERSION;
+    header.binary_format = binary_format;
+    header.key = key;
+    header.binary_length = binary_length;
+    header.build_ms = build_ms;
+
+    // Write to a temporary file first so that an interrupted write never leaves a corrupt cache behind
+    std::error_code err;
+    fs::create_directories(PROGRAM_CACHE_DIRECTORY, err);
+    std::string cache_path = program_cache_path_of(key);
+    std::string temp_path = cache_path + ".tmp";
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "Error: cannot write program cache " << temp_path << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(binary.data(), binary.size());
+    out.close();
+    if (!out)
+    {
+        std::cout << "Error: failed writing program cache " << temp_path << std::endl;
+        fs::remove(temp_path, err);
+        return false;
+    }
+
+    fs::rename(temp_path, cache_path, err);
+    return !err;
+}
+
+#else
+
+// Never called, program_cache_supported() is false without the extension
+bool load_program_cache(uint, uint64_t, float &)
+{
+    return false;
+}
+
+bool save_program_cache(uint, uint64_t, float)
+{
+    return false;
+}
+
+#endif // GL_ARB_get_program_binary
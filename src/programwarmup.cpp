@@ -0,0 +1,115 @@
+#include <iostream>
+#include <glad/gl.h>
+#include "programwarmup.h"
+#include "glstate.h"
+
+ProgramWarmup::ProgramWarmup(bool &success) : 
+    num_programs(0), num_frames(0), reported(false), start_time(std::chrono::steady_clock::now())
+{
+    success = true;
+    Shaders::enable_parallel_compile();
+
+    // Create renderbuffers (color, object IDs, depth+stencil), one pixel is enough
+    glGenRenderbuffers(1, &color_renderbuffer_id);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_renderbuffer_id);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 1, 1);
+    glGenRenderbuffers(1, &id_renderbuffer_id);
+    glBindRenderbuffer(GL_RENDERBUFFER, id_renderbuffer_id);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_R32UI, 1, 1);
+    glGenRenderbuffers(1, &depth_renderbuffer_id);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_renderbuffer_id);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, 1, 1);
+
+    // Create framebuffer
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_renderbuffer_id);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_RENDERBUFFER, id_renderbuffer_id);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_renderbuffer_id);
+    const GLenum draw_buffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, draw_buffers);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "Error: Incomplete framebuffer" << std::endl;
+        success = false;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Core profile needs a vertex array bound to draw, even without attributes
+    glGenVertexArrays(1, &array_obj);
+}
+
+ProgramWarmup::~ProgramWarmup()
+{
+    std::cout << "NOTE: deleting warmup framebuffer " << fbo << " and its attached buffers" << std::endl;
+    Shaders::release_shader_objects();
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &color_renderbuffer_id);
+    glDeleteRenderbuffers(1, &id_renderbuffer_id);
+    glDeleteRenderbuffers(1, &depth_renderbuffer_id);
+    state_forget_vertex_array(array_obj);
+    glDeleteVertexArrays(1, &array_obj);
+}
+
+void ProgramWarmup::add(Shaders &program)
+{
+    pending.push_back(&program);
+    num_programs++;
+}
+
+bool ProgramWarmup::update()
+{
+    if (pending.empty())
+    {
+        return true;
+    }
+    num_frames++;
+
+    // Finish programs in order of priority, skipping those the driver is still building
+    bool parallel = Shaders::parallel_compile_supported();
+    bool bound = false;
+    for (auto it = pending.begin(); it != pending.end();)
+    {
+        Shaders &program = **it;
+        if (!program.ready())
+        {
+            ++it;
+            continue;
+        }
+        if (!program.finish())
+        {
+            return false;
+        }
+
+        // Draw off-screen with the same kind of framebuffer as the main pass
+        if (!bound)
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            state_bind_vertex_array(array_obj);
+            bound = true;
+        }
+        program.warm_up();
+        it = pending.erase(it);
+        if (!parallel) break;
+    }
+    if (bound)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // Report startup once. Shader objects stay alive, variants added later share the vertex shader.
+    if (pending.empty() && !reported)
+    {
+        std::chrono::duration<float, std::milli> total_time = std::chrono::steady_clock::now() - start_time;
+        std::cout << "All " << num_programs << " shader programs ready after " << total_time.count() << "ms ";
+        std::cout << "(" << num_frames << " frames, " << (parallel ? "parallel" : "serial") << " compile)" << std::endl;
+        Shaders::print_stats();
+        reported = true;
+    }
+    return true;
+}
+
+bool ProgramWarmup::done() const
+{
+    return pending.empty();
+}
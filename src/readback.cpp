@@ -0,0 +1,63 @@
+#include <iostream>
+#include <glad/gl.h>
+#include "readback.h"
+
+Readback::Readback(size_t size) : size(size), fence(nullptr)
+{
+    glGenBuffers(1, &pixel_buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+Readback::~Readback()
+{
+    std::cout << "NOTE: deleting read back buffer " << pixel_buffer << std::endl;
+    if (fence)
+    {
+        glDeleteSync(static_cast<GLsync>(fence));
+    }
+    glDeleteBuffers(1, &pixel_buffer);
+}
+
+bool Readback::busy() const
+{
+    return fence;
+}
+
+void Readback::start(uint x, uint y, uint width, uint height)
+{
+    // Copy into the pixel buffer, and mark the point in the command stream after which the copy is complete
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer);
+    glReadPixels(x, y, width, height, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool Readback::poll(const uint *&data)
+{
+    if (!fence)
+    {
+        return false;
+    }
+
+    // Check without waiting, the flush makes sure the fence eventually gets signaled
+    GLenum status = glClientWaitSync(static_cast<GLsync>(fence), GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+    {
+        return false;
+    }
+    glDeleteSync(static_cast<GLsync>(fence));
+    fence = nullptr;
+
+    // The copy is done, so mapping does not stall
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer);
+    data = static_cast<const uint *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+    return true;
+}
+
+void Readback::unmap()
+{
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
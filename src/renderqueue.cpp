@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <glad/gl.h>
+#include "renderqueue.h"
+#include "framestats.h"
+#include "gpuprofiler.h"
+
+void RenderQueue::clear()
+{
+    packets.clear();
+    uploads.clear();
+}
+
+uint64_t RenderQueue::program_index(const Shaders &program)
+{
+    for (size_t i = 0; i < programs.size(); i++)
+    {
+        if (programs[i] == &program) return i;
+    }
+    programs.push_back(&program);
+    return programs.size() - 1;
+}
+
+uint RenderQueue::add_instances(uint buffer, const std::vector<InstanceData> &instances, const size_t &capacity)
+{
+    uploads.emplace_back(InstanceUpload{buffer, &instances, &capacity});
+    return uploads.size() - 1;
+}
+
+void RenderQueue::upload_instances(uint upload)
+{
+    const InstanceUpload &pending = uploads[upload];
+    auto contents = std::find_if(buffer_contents.begin(), buffer_contents.end(),
+                                 [&](const std::pair<uint, uint> &c) { return c.first == pending.buffer; });
+    if (contents != buffer_contents.end() && contents->second == upload)
+    {
+        return;
+    }
+    if (contents == buffer_contents.end()) buffer_contents.emplace_back(pending.buffer, upload);
+    else contents->second = upload;
+
+    // Upload into fresh storage, so that draws still reading the previous contents neither stall nor see it
+    glBindBuffer(GL_ARRAY_BUFFER, pending.buffer);
+    glBufferData(GL_ARRAY_BUFFER, *pending.capacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, pending.instances->size() * sizeof(InstanceData), pending.instances->data());
+}
+
+void RenderQueue::push(const Shaders &program, const Mesh &mesh, uint upload, bool with_textures, float depth,
+                       const char *label)
+{
+    // Quantize depth to 24 bits, anything beyond MAX_DEPTH sorts last
+    float normalized_depth = std::clamp(depth / MAX_DEPTH, 0.f, 1.f);
+    uint64_t depth_bits = static_cast<uint64_t>(normalized_depth * 0xFFFFFF);
+
+    uint64_t key = (program_index(program) & 0xFF) << 56;
+    key |= (with_textures ? (mesh.texture_set & 0xFFFF) : 0) << 40;
+    key |= static_cast<uint64_t>(mesh.vertex_array() & 0xFFFF) << 24;
+    key |= depth_bits;
+    uint num_instances = uploads[upload].instances->size();
+    packets.emplace_back(DrawPacket{key, &program, &mesh, num_instances, with_textures, label, upload});
+}
+
+void RenderQueue::submit(GpuProfiler *gpu_profiler)
+{
+    std::sort(packets.begin(), packets.end(), [](const DrawPacket &a, const DrawPacket &b) { return a.key < b.key; });
+
+    // Bind only what differs from the previous packet
+    const Shaders *cur_program = nullptr;
+    const Mesh *cur_mesh = nullptr;
+    uint64_t cur_texture_set = 0;
+    bool textures_bound = false;
+    buffer_contents.clear();
+    for (const DrawPacket &packet : packets)
+    {
+        upload_instances(packet.upload);
+
+        if (packet.program != cur_program)
+        {
+            if (cur_program) cur_program->uniform_int("instanced", 0);
+            cur_program = packet.program;
+            cur_program->use();
+            cur_program->uniform_int("instanced", 1);
+
+            // Sampler uniforms belong to the program, so textures must be set again
+            textures_bound = false;
+        }
+        else
+        {
+            frame_stats.program_binds_avoided++;
+        }
+
+        if (packet.with_textures)
+        {
+            if (!textures_bound || packet.mesh->texture_set != cur_texture_set)
+            {
+                packet.mesh->bind_textures(*cur_program);
+                cur_texture_set = packet.mesh->texture_set;
+                textures_bound = true;
+            }
+            else
+            {
+                frame_stats.texture_binds_avoided++;
+            }
+        }
+
+        if (packet.mesh != cur_mesh)
+        {
+            packet.mesh->bind_vertices();
+            cur_mesh = packet.mesh;
+        }
+        else
+        {
+            frame_stats.vertex_array_binds_avoided++;
+        }
+
+        if (gpu_profiler)
+        {
+            GPU_PROFILE_ZONE(*gpu_profiler, packet.label ? packet.label : "draw");
+            packet.mesh->draw_elements(packet.num_instances);
+        }
+        else
+        {
+            packet.mesh->draw_elements(packet.num_instances);
+        }
+    }
+    if (cur_program) cur_program->uniform_int("instanced", 0);
+}
@@ -0,0 +1,131 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include "hash.h"
+#include "mappedfile.h"
+#include "texturecache.h"
+#include "sceneloader.h"
+#include "profiler.h"
+
+using LoadClock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<float, std::milli>;
+
+SceneLoader::SceneLoader(uint num_threads) : pool(num_threads), cpu_ms(0.f), total_ms(0.f)
+{
+    // Left empty intentionally
+}
+
+void SceneLoader::request(const std::string &filepath)
+{
+    for (const PendingAsset &asset : pending)
+    {
+        if (asset.filepath == filepath) return;
+    }
+    PendingAsset &asset = pending.emplace_back();
+    asset.filepath = filepath;
+    asset.num_textures = 0;
+    asset.decode_ms = 0.f;
+    asset.upload_ms = 0.f;
+}
+
+void SceneLoader::read_model(size_t index)
+{
+    PROFILE_ZONE("read model");
+    PendingAsset &asset = pending[index];
+    ModelAsset::load_data(asset.filepath, asset.data);
+
+    // Hand every texture that no other model claimed yet to its own decoding task
+    std::string directory = ModelAsset::directory_of(asset.filepath);
+    for (const MeshData &mesh : asset.data.meshes)
+    {
+        for (const TextureRef &ref : mesh.textures)
+        {
+            std::string path = directory + ref.path;
+            PendingTexture *texture;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!claimed_textures.insert(path).second) continue;
+                pending_textures.emplace_back(std::make_unique<PendingTexture>());
+                texture = pending_textures.back().get();
+            }
+            texture->path = path;
+            texture->owner = index;
+            pool.submit([this, texture] { decode_texture(texture); });
+        }
+    }
+}
+
+void SceneLoader::decode_texture(PendingTexture *texture)
+{
+    PROFILE_ZONE("decode texture");
+    auto start_time = LoadClock::now();
+    MappedFile file(texture->path);
+    texture->hashed = file.is_open();
+    if (texture->hashed)
+    {
+        texture->hash = hash_bytes(file.data, file.size);
+        texture->image = std::make_unique<Image>(file.data, file.size, texture->path);
+    }
+    texture->decode_ms = Milliseconds(LoadClock::now() - start_time).count();
+}
+
+void SceneLoader::load_all()
+{
+    // Read everything on the workers.
+    // pending is not resized from here on, so tasks may hold references into it.
+    PROFILE_ZONE("SceneLoader::load_all");
+    auto start_time = LoadClock::now();
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        pool.submit([this, i] { read_model(i); });
+    }
+    pool.wait();
+    cpu_ms = Milliseconds(LoadClock::now() - start_time).count();
+
+    // Upload textures first so that assets find them in the cache
+    for (const std::unique_ptr<PendingTexture> &texture : pending_textures)
+    {
+        PendingAsset &owner = pending[texture->owner];
+        owner.num_textures++;
+        owner.decode_ms += texture->decode_ms;
+        if (!texture->hashed || !texture->image->is_valid())
+        {
+            // Leave it to the cache to report the error when the asset asks for it
+            continue;
+        }
+        auto upload_start = LoadClock::now();
+        textures.emplace_back(TextureCache::insert(texture->path, texture->hash, *texture->image));
+        owner.upload_ms += Milliseconds(LoadClock::now() - upload_start).count();
+    }
+    pending_textures.clear();
+
+    // Upload meshes
+    for (PendingAsset &asset : pending)
+    {
+        auto upload_start = LoadClock::now();
+        assets.emplace_back(ModelAsset::create(asset.filepath, asset.data));
+        asset.upload_ms += Milliseconds(LoadClock::now() - upload_start).count();
+
+        // Release CPU copies (or the cache mapping) now that they are on the GPU
+        asset.data.meshes.clear();
+        asset.data.meshes.shrink_to_fit();
+        asset.data.mapping.reset();
+    }
+    total_ms = Milliseconds(LoadClock::now() - start_time).count();
+}
+
+void SceneLoader::print_timings() const
+{
+    std::cout << "Loaded " << pending.size() << " models on " << pool.size() << " threads in " << total_ms << "ms ";
+    std::cout << "(" << cpu_ms << "ms reading and decoding, " << total_ms - cpu_ms << "ms uploading)" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (const PendingAsset &asset : pending)
+    {
+        std::cout << "  " << asset.filepath << ": ";
+        std::cout << (asset.data.from_cache ? "cache read " : "assimp import ") << asset.data.read_ms << "ms, ";
+        std::cout << "vertex conversion " << asset.data.convert_ms << "ms, ";
+        std::cout << "decoding " << asset.num_textures << " textures " << asset.decode_ms << "ms, ";
+        std::cout << "upload " << asset.upload_ms << "ms" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
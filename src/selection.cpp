@@ -2,65 +2,173 @@
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 #include "selection.h"
+#include "glstate.h"
+#include "framestats.h"
 
-Selection::Selection(uint width, uint height, bool &success)
+Selection::Selection(uint width, uint height, bool &success) : 
+    read_x(0), read_y(0), width(width), height(height), readback(sizeof(uint)), 
+    click_requested(false), hover_requested(false), click_x(0), click_y(0), hover_x(0), hover_y(0), 
+    reading_click(false)
 {
     success = true;
 
-    // Create and bind framebuffer 
-    glGenFramebuffers(1, &fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-
-    // Create and attach texture (color buffer)
+    // Create texture (object IDs)
     glGenTextures(1, &texture_id);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+    state_bind_texture(0, GL_TEXTURE_2D, texture_id);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture_id, 0);
-    
-    // Create and attach renderbuffer (depth+stencil buffer)
+
+    // Create renderbuffers (depth+stencil buffer, color buffer)
     glGenRenderbuffers(1, &renderbuffer_id);
     glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer_id);
     glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glGenRenderbuffers(1, &color_renderbuffer_id);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_renderbuffer_id);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    // Create framebuffer of the separate ID pass, IDs go to the only color attachment
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture_id, 0);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderbuffer_id);
-    
-    // Check for errors
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
     {
         std::cout << "Error: Incomplete framebuffer" << std::endl;
         success = false;
     }
-    
+
+    // Create framebuffer of the main pass, color to the first attachment and IDs to the second
+    glGenFramebuffers(1, &scene_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, scene_fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_renderbuffer_id);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, texture_id, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, renderbuffer_id);
+    const GLenum draw_buffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, draw_buffers);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "Error: Incomplete framebuffer" << std::endl;
+        success = false;
+    }
+
     // Rebind default framebuffer for on-screen rendering
-    end();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    track_gpu_memory(GPU_MEMORY_SELECTION, gpu_bytes());
 }
 
 Selection::~Selection()
 {
-    std::cout << "NOTE: deleteing framebuffer " << fbo << " and its attached buffers" << std::endl;
+    std::cout << "NOTE: deleteing framebuffers " << fbo << ", " << scene_fbo << " and their attached buffers" << std::endl;
+    track_gpu_memory(GPU_MEMORY_SELECTION, -(int64_t)gpu_bytes());
+    glDeleteFramebuffers(1, &scene_fbo);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &color_renderbuffer_id);
     glDeleteRenderbuffers(1, &renderbuffer_id);
+    state_forget_texture(texture_id);
     glDeleteTextures(1, &texture_id);
-    glDeleteFramebuffers(1, &fbo);
 }
 
-void Selection::start() const
+size_t Selection::gpu_bytes() const
 {
-    // Bind framebuffer and clear it 
+    // Object IDs, depth+stencil and color take 4 bytes per pixel each, plus the read back pixel
+    return (size_t)width * height * 4 * 3 + sizeof(uint);
+}
+
+void Selection::request_pick(uint x, uint y)
+{
+    click_x = x;
+    click_y = y;
+    click_requested = true;
+}
+
+void Selection::request_hover(uint x, uint y)
+{
+    hover_x = x;
+    hover_y = y;
+    hover_requested = true;
+}
+
+bool Selection::needs_pass() const
+{
+    return (click_requested || hover_requested) && !readback.busy();
+}
+
+uint Selection::ids() const
+{
+    return texture_id;
+}
+
+void Selection::choose_read()
+{
+    reading_click = click_requested;
+    read_x = reading_click ? click_x : hover_x;
+    read_y = reading_click ? click_y : hover_y;
+    if (reading_click) click_requested = false;
+    else hover_requested = false;
+}
+
+void Selection::start_scene() const
+{
+    // Bind framebuffer and clear color, IDs (to no object), depth and stencil
+    glBindFramebuffer(GL_FRAMEBUFFER, scene_fbo);
+    const float black[] = {0.f, 0.f, 0.f, 1.f};
+    const uint no_object[] = {0, 0, 0, 0};
+    glClearBufferfv(GL_COLOR, 0, black);
+    glClearBufferuiv(GL_COLOR, 1, no_object);
+    glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+}
+
+void Selection::end_scene(bool read_ids)
+{
+    // Read back IDs only if the main pass is the picking source, a read is asked for and the previous one is done
+    if (read_ids && needs_pass())
+    {
+        choose_read();
+        glReadBuffer(GL_COLOR_ATTACHMENT1);
+        readback.start(read_x, read_y, 1, 1);
+    }
+
+    // Copy color to the screen
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, scene_fbo);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+    // Bind default framebuffer
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Selection::start()
+{
+    // Bind framebuffer and clear the pixel being read only, the scissor also limits all draws to it
+    choose_read();
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glClearColor(0.f, 0.f, 0.f, 1.f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    state_set_capability(GL_SCISSOR_TEST, true);
+    glScissor(read_x, read_y, 1, 1);
+    const uint no_object[] = {0, 0, 0, 0};
+    glClearBufferuiv(GL_COLOR, 0, no_object);
+    glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 }
 
-void Selection::end() const
+void Selection::end()
 {
+    readback.start(read_x, read_y, 1, 1);
+
     // Bind default framebuffer
+    state_set_capability(GL_SCISSOR_TEST, false);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-uint Selection::object_at(int x, int y) const
+bool Selection::poll(uint &object_id, bool &is_click)
 {
-    uint data;
-    glReadPixels(x, y, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, &data);
-    return data;
+    const uint *data;
+    if (!readback.poll(data))
+    {
+        return false;
+    }
+    object_id = data ? *data : 0;
+    readback.unmap();
+    is_click = reading_click;
+    return true;
 }
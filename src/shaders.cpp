@@ -1,183 +1,438 @@
 #include <iostream>
 #include <math.h>
+#include <algorithm>
+#include <climits>
+#include <chrono>
+#include <unordered_map>
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 #include <glm/gtc/type_ptr.hpp>
 #include "shaders.h"
+#include "frameuniforms.h"
+#include "glstate.h"
+#include "programcache.h"
+#include "shadersource.h"
+#include "profiler.h"
 
-#define MAX_SHADER_LENGTH 1024 * 10
+uint Shaders::location_queries = 0;
+uint Shaders::shaders_compiled = 0;
+uint Shaders::shaders_reused = 0;
+uint Shaders::programs_built = 0;
+uint Shaders::programs_from_cache = 0;
+float Shaders::build_ms = 0.f;
+float Shaders::saved_ms = 0.f;
 
-void Shaders::uniform_vec3(const std::string &uniform_name, glm::vec3 v) const
+void Shaders::uniform_vec3(Uniform uniform, glm::vec3 v) const
 {
-    int unif_loc = glGetUniformLocation(id, uniform_name.c_str());
+    int unif_loc = location_of(uniform);
     if (unif_loc == -1)
     {
-        // std::cout << "Error: Cannot set uniform " << uniform_name << "" << std::endl;
         return;
     }
     glUniform3f(unif_loc, v.x, v.y, v.z);
 }
 
-void Shaders::uniform_vec4(const std::string &uniform_name, glm::vec4 v) const
+void Shaders::uniform_vec4(Uniform uniform, glm::vec4 v) const
 {
-    int unif_loc = glGetUniformLocation(id, uniform_name.c_str());
+    int unif_loc = location_of(uniform);
     if (unif_loc == -1)
     {
-        // std::cout << "Error: Cannot set uniform " << uniform_name << "" << std::endl;
         return;
     }
     glUniform4f(unif_loc, v.x, v.y, v.z, v.w);
 }
 
-void Shaders::uniform_mat4(const std::string &uniform_name, glm::mat4 matrix) const
+void Shaders::uniform_mat4(Uniform uniform, glm::mat4 matrix) const
 {
-    int unif_loc = glGetUniformLocation(id, uniform_name.c_str());
+    int unif_loc = location_of(uniform);
     if (unif_loc == -1)
     {
-        // std::cout << "Error: Cannot set uniform " << uniform_name << "" << std::endl;
         return;
     }
     glUniformMatrix4fv(unif_loc, 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
-void Shaders::uniform_mat3(const std::string &uniform_name, glm::mat3 matrix) const
+void Shaders::uniform_mat3(Uniform uniform, glm::mat3 matrix) const
 {
-    int unif_loc = glGetUniformLocation(id, uniform_name.c_str());
+    int unif_loc = location_of(uniform);
     if (unif_loc == -1)
     {
-        // std::cout << "Error: Cannot set uniform " << uniform_name << "" << std::endl;
         return;
     }
     glUniformMatrix3fv(unif_loc, 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
-void Shaders::uniform_float(const std::string &uniform_name, float f) const
+void Shaders::uniform_float(Uniform uniform, float f) const
 {
-    int unif_loc = glGetUniformLocation(id, uniform_name.c_str());
+    int unif_loc = location_of(uniform);
     if (unif_loc == -1)
     {
-        // std::cout << "Error: Cannot set uniform " << uniform_name << "" << std::endl;
         return;
     }
     glUniform1f(unif_loc, f);
 }
 
-void Shaders::uniform_modulation(const std::string &uniform_name) const
+void Shaders::uniform_modulation(Uniform uniform) const
 {
     double time = glfwGetTime();
     double modulation = (sin(time) + 1) / 2.0;
-    uniform_float(uniform_name, modulation);
+    uniform_float(uniform, modulation);
 }
 
-void Shaders::uniform_int(const std::string &uniform_name, int i) const
+void Shaders::uniform_int(Uniform uniform, int i) const
 {
-    int unif_loc = glGetUniformLocation(id, uniform_name.c_str());
+    int unif_loc = location_of(uniform);
     if (unif_loc == -1)
     {
-        // std::cout << "Error: Cannot set uniform " << uniform_name << "" << std::endl;
+        return;
     }
     glUniform1i(unif_loc, i);
 }
 
-void Shaders::uniform_uint(const std::string &uniform_name, uint u) const
+void Shaders::uniform_uint(Uniform uniform, uint u) const
 {
-    int unif_loc = glGetUniformLocation(id, uniform_name.c_str());
+    int unif_loc = location_of(uniform);
     if (unif_loc == -1)
     {
-        // std::cout << "Error: Cannot set uniform " << uniform_name << "" << std::endl;
+        return;
     }
     glUniform1ui(unif_loc, u);
 }
 
+int Shaders::location_of(Uniform uniform) const
+{
+    // Binary search, the table is small and sorted at link time
+    auto found = std::lower_bound(locations.begin(), locations.end(), std::make_pair(uniform.hash, INT_MIN));
+    if (found == locations.end() || found->first != uniform.hash)
+    {
+        // Uniform is unused by this program (or optimized out by the driver)
+        return -1;
+    }
+    return found->second;
+}
+
+bool is_sampler(GLenum type)
+{
+    switch (type)
+    {
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_BUFFER:
+    case GL_INT_SAMPLER_2D:
+    case GL_INT_SAMPLER_BUFFER:
+    case GL_UNSIGNED_INT_SAMPLER_2D:
+    case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void Shaders::resolve_locations()
+{
+    // Ask the driver for every active uniform once, instead of by name on every call
+    int num_uniforms, max_name_length;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &num_uniforms);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+    std::vector<char> name(max_name_length + 1);
+    for (int i = 0; i < num_uniforms; i++)
+    {
+        int size;
+        GLenum type;
+        glGetActiveUniform(id, i, name.size(), nullptr, &size, &type, name.data());
+        int location = glGetUniformLocation(id, name.data());
+        location_queries++;
+        if (location == -1)
+        {
+            // Member of a uniform block, not set through locations
+            continue;
+        }
+        locations.emplace_back(hash_name(name.data()), location);
+        if (is_sampler(type))
+        {
+            samplers.push_back(location);
+        }
+
+        // Arrays are reported as "name[0]", also make them reachable as "name"
+        std::string array_name(name.data());
+        if (array_name.size() > 3 && array_name.compare(array_name.size() - 3, 3, "[0]") == 0)
+        {
+            array_name.resize(array_name.size() - 3);
+            locations.emplace_back(hash_name(array_name.c_str()), location);
+        }
+    }
+    std::sort(locations.begin(), locations.end());
+
+    // Two names with the same hash would silently alias each other
+    for (size_t i = 1; i < locations.size(); i++)
+    {
+        if (locations[i].first == locations[i - 1].first)
+        {
+            std::cout << "Error: uniform name hash collision in shader program " << id << std::endl;
+        }
+    }
+}
+
+void Shaders::bind_frame_data() const
+{
+    uint block_index = glGetUniformBlockIndex(id, "FrameData");
+    if (block_index == GL_INVALID_INDEX)
+    {
+        // Program does not read per-frame data
+        return;
+    }
+    glUniformBlockBinding(id, block_index, FRAME_DATA_BINDING);
+}
+
 void Shaders::use() const
 {
-    glUseProgram(id);
+    state_use_program(id);
 }
 
-void Shaders::set_transforms(const glm::mat4 &model, const glm::mat4 &view, const glm::mat4 &projection) const
+void Shaders::set_transforms(const glm::mat4 &model) const
 {
     use();
-    glm::mat4 mvp = projection * view * model;
     uniform_mat4("m", model);
-    uniform_mat4("mvp", mvp);
     uniform_mat3("m_for_normals", glm::transpose(glm::inverse(model)));
 }
 
 Shaders::~Shaders()
 {
     std::cout << "NOTE: deleting shader program " << id << std::endl;
+    state_forget_program(id);
     glDeleteProgram(id);
 }
 
-uint compile_shader(std::string shader_path, GLenum shader_type)
-{
-    int success;
-    char compilation_errs[512];
-    FILE *shader_file;
-    char shader_txt[MAX_SHADER_LENGTH];
+// Shader objects compiled so far by source hash and type, shared files are compiled once
+std::unordered_map<uint64_t, uint> compiled_shaders;
 
-    // Read shader code
-    shader_file = fopen(shader_path.c_str(), "r");
-    if (!shader_file)
+uint compile_shader(const ShaderSource &source, GLenum shader_type)
+{
+    uint64_t key = hash_bytes(&shader_type, sizeof(shader_type), source.hash);
+    auto found = compiled_shaders.find(key);
+    if (found != compiled_shaders.end())
     {
-        std::cout << "Cannot find shader file: " << shader_path << std::endl;
-        return 0;
+        Shaders::shaders_reused++;
+        return found->second;
     }
-    int filesize = fread(shader_txt, sizeof(char), MAX_SHADER_LENGTH, shader_file);
-    shader_txt[filesize] = '\0';
-    fclose(shader_file);
-    const char *shader_src = shader_txt;
 
-    // Compile shader
+    // Start compiling, the status is checked only once the program is finished
+    const char *shader_src = source.text.c_str();
     uint shader = glCreateShader(shader_type);
     glShaderSource(shader, 1, &shader_src, nullptr);
     glCompileShader(shader);
+    Shaders::shaders_compiled++;
+    compiled_shaders[key] = shader;
+    return shader;
+}
+
+bool use_program_cache()
+{
+    static const bool supported = program_cache_supported();
+    return supported;
+}
+
+bool check_shader(uint shader, const ShaderSource &source)
+{
+    int success;
+    char compilation_errs[512];
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success)
     {
         glGetShaderInfoLog(shader, 512, nullptr, compilation_errs);
-        std::cout << "Error compiling shader (" << shader_path << "): " << std::endl;
-        std::cout << compilation_errs << std::endl << std::endl;
-        return 0;
+        std::cout << "Error compiling shader (" << source.files[0] << "): " << std::endl;
+        std::cout << compilation_errs << std::endl;
+        print_source_files(source);
+        std::cout << std::endl;
     }
-    return shader;
+    return success;
 }
 
-Shaders::Shaders(const std::string &vertex_shader_path, const std::string &fragment_shader_path, bool &success)
+bool Shaders::parallel_compile_supported()
 {
-    // Compile vertex shader
-    uint vertex_shader = compile_shader(vertex_shader_path, GL_VERTEX_SHADER);
-    if (0 == vertex_shader)
-    {
-        success = false;
-        return;
-    }
+#ifdef GL_KHR_parallel_shader_compile
+    return GLAD_GL_KHR_parallel_shader_compile;
+#else
+    // GLAD was generated without the extension
+    return false;
+#endif
+}
 
-    // Compile fragment shader
-    uint fragment_shader = compile_shader(fragment_shader_path, GL_FRAGMENT_SHADER);
-    if (0 == fragment_shader)
+void Shaders::enable_parallel_compile()
+{
+    // Let the driver compile and link on as many threads as it likes
+    if (parallel_compile_supported())
     {
-        success = false;
-        return;
+#ifdef GL_KHR_parallel_shader_compile
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+#endif
     }
+}
 
-    // Link shader program
-    int linking_success;
-    char compilation_errs[512];
+Shaders::Shaders(const std::string &vertex_shader_path, const std::string &fragment_shader_path, bool &success,
+                 const std::string &fragment_defines) : 
+    vertex_shader(0), fragment_shader(0), key(0), from_cache(false), finished(false), 
+    cached_build_ms(0.f), main_thread_ms(0.f), submit_time(std::chrono::steady_clock::now()), ready_ms(-1.f)
+{
+    PROFILE_ZONE("Shaders::Shaders");
+    success = false;
     id = glCreateProgram();
-    glAttachShader(id, vertex_shader);
-    glAttachShader(id, fragment_shader);
-    glLinkProgram(id);
-    glGetProgramiv(id, GL_LINK_STATUS, &linking_success);
-    if (!linking_success)
-    {
-        glGetProgramInfoLog(id, 512, nullptr, compilation_errs);
-        std::cout << "Error linking shader program: " << std::endl;
-        std::cout << compilation_errs << std::endl << std::endl;
-        success = false;
+
+    // Read and preprocess sources, which is all it takes to find a cached binary
+    const ShaderSource *vertex_source = load_shader_source(vertex_shader_path);
+    const ShaderSource *fragment_file = load_shader_source(fragment_shader_path);
+    if (!vertex_source || !fragment_file)
+    {
         return;
     }
-    glDeleteShader(vertex_shader);
-    glDeleteShader(fragment_shader);
+    ShaderSource defined_fragment = with_defines(*fragment_file, fragment_defines);
+    const ShaderSource *fragment_source = &defined_fragment;
+
+    // Remember which files went in, without their text
+    vertex_files.files = vertex_source->files;
+    fragment_files.files = fragment_source->files;
+    static const uint64_t driver = driver_hash();
+    key = hash_bytes(&vertex_source->hash, sizeof(uint64_t), driver);
+    key = hash_bytes(&fragment_source->hash, sizeof(uint64_t), key);
     success = true;
+
+    // Warm start: load the linked program as saved by an earlier run
+    if (use_program_cache() && load_program_cache(id, key, cached_build_ms))
+    {
+        from_cache = true;
+    }
+    else
+    {
+        // Cold start: start compiling (or reuse) both shaders and linking, without waiting for either
+        vertex_shader = compile_shader(*vertex_source, GL_VERTEX_SHADER);
+        fragment_shader = compile_shader(*fragment_source, GL_FRAGMENT_SHADER);
+        glAttachShader(id, vertex_shader);
+        glAttachShader(id, fragment_shader);
+#ifdef GL_ARB_get_program_binary
+        if (use_program_cache())
+        {
+            glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+#endif
+        glLinkProgram(id);
+    }
+    std::chrono::duration<float, std::milli> submit_duration = std::chrono::steady_clock::now() - submit_time;
+    main_thread_ms = submit_duration.count();
+}
+
+bool Shaders::ready() const
+{
+    if (finished || from_cache || !parallel_compile_supported())
+    {
+        // Without the extension there is no way to ask, finish() may block
+        return true;
+    }
+    int completed = 1;
+#ifdef GL_KHR_parallel_shader_compile
+    glGetProgramiv(id, GL_COMPLETION_STATUS_KHR, &completed);
+#endif
+    if (completed && ready_ms < 0.f)
+    {
+        // Driver threads built the program in the meantime, only the wall clock tells how long that took
+        std::chrono::duration<float, std::milli> ready_time = std::chrono::steady_clock::now() - submit_time;
+        ready_ms = ready_time.count();
+    }
+    return completed;
+}
+
+bool Shaders::usable() const
+{
+    return finished;
+}
+
+bool Shaders::finish()
+{
+    if (finished)
+    {
+        return true;
+    }
+    PROFILE_ZONE("Shaders::finish");
+    auto finish_start = std::chrono::steady_clock::now();
+
+    // Check the link, which waits for the driver unless ready() said so
+    if (!from_cache)
+    {
+        int linking_success;
+        char compilation_errs[512];
+        glGetProgramiv(id, GL_LINK_STATUS, &linking_success);
+        if (!linking_success)
+        {
+            check_shader(vertex_shader, vertex_files);
+            check_shader(fragment_shader, fragment_files);
+            glGetProgramInfoLog(id, 512, nullptr, compilation_errs);
+            std::cout << "Error linking shader program: " << std::endl;
+            std::cout << compilation_errs << std::endl << std::endl;
+            return false;
+        }
+        glDetachShader(id, vertex_shader);
+        glDetachShader(id, fragment_shader);
+    }
+    resolve_locations();
+    bind_frame_data();
+    finished = true;
+
+    // Account for the time this program held up the main thread
+    std::chrono::duration<float, std::milli> finish_time = std::chrono::steady_clock::now() - finish_start;
+    main_thread_ms += finish_time.count();
+    build_ms += main_thread_ms;
+    programs_built++;
+    if (from_cache)
+    {
+        programs_from_cache++;
+        saved_ms += cached_build_ms - main_thread_ms;
+    }
+    else if (use_program_cache())
+    {
+        // With parallel compile, most of the build ran on driver threads and is only seen by the wall clock.
+        // It is measured at the first ready() poll, so it may be up to a frame late.
+        save_program_cache(id, key, ready_ms >= 0.f ? ready_ms : main_thread_ms);
+    }
+    return true;
+}
+
+void Shaders::warm_up() const
+{
+    // Point every sampler at its own texture unit, the driver refuses draws that mix sampler types on one unit
+    use();
+    for (size_t i = 0; i < samplers.size(); i++)
+    {
+        glUniform1i(samplers[i], i);
+    }
+
+    // A single degenerate triangle goes through the whole pipeline without covering any pixel.
+    // Attributes are disabled (see ProgramWarmup), so every vertex reads the same constant values.
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // Restore samplers to their initial unit, as if the program had never been used
+    for (int sampler : samplers)
+    {
+        glUniform1i(sampler, 0);
+    }
+}
+
+void Shaders::release_shader_objects()
+{
+    // Linked programs keep working without the shader objects they were built from.
+    // Preprocessed sources stay cached (see load_shader_source).
+    for (const auto &shader : compiled_shaders)
+    {
+        glDeleteShader(shader.second);
+    }
+    compiled_shaders.clear();
+}
+
+void Shaders::print_stats()
+{
+    std::cout << "Shader programs: " << programs_built << " built in " << build_ms << "ms, ";
+    std::cout << programs_from_cache << " from binary cache";
+    if (programs_from_cache > 0)
+    {
+        std::cout << " (saved about " << saved_ms << "ms of compiling and linking)";
+    }
+    std::cout << ", " << shaders_compiled << " shaders compiled, " << shaders_reused << " reused" << std::endl;
 }
@@ -0,0 +1,138 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <unordered_map>
+#include "hash.h"
+#include "shadersource.h"
+
+namespace fs = std::filesystem;
+
+// Preprocessed sources by path of the root file
+std::unordered_map<std::string, ShaderSource> shader_sources;
+
+// Includes nested deeper than this are assumed to be a mistake
+const int MAX_INCLUDE_DEPTH = 16;
+
+int64_t write_time_of(const std::string &path)
+{
+    std::error_code err;
+    fs::file_time_type write_time = fs::last_write_time(path, err);
+    return err ? -1 : write_time.time_since_epoch().count();
+}
+
+// Append a file to the source, recursing into its includes. Returns false if any file cannot be read.
+bool append_file(const std::string &path, int depth, ShaderSource &source, std::string &text)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cout << "Cannot find shader file: " << path << std::endl;
+        return false;
+    }
+    int file_index = source.files.size();
+    source.files.push_back(path);
+    source.write_times.push_back(write_time_of(path));
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        line_number++;
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line.compare(start, 8, "#include") != 0)
+        {
+            text += line;
+            text += '\n';
+            continue;
+        }
+
+        // Parse the quoted path, relative to this file
+        size_t open = line.find('"', start + 8);
+        size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos)
+        {
+            std::cout << "Error: malformed #include in " << path << ":" << line_number << std::endl;
+            return false;
+        }
+        fs::path include_path = fs::path(path).parent_path() / line.substr(open + 1, close - open - 1);
+        std::string include = include_path.lexically_normal().string();
+
+        // Included already (directly or not), leave an empty line so that line numbers stay the same
+        bool included = false;
+        for (const std::string &f : source.files)
+        {
+            if (f == include) included = true;
+        }
+        if (included)
+        {
+            text += '\n';
+            continue;
+        }
+        if (depth + 1 > MAX_INCLUDE_DEPTH)
+        {
+            std::cout << "Error: includes nested too deep in " << path << ":" << line_number << std::endl;
+            return false;
+        }
+
+        // Number lines of the included file by its own index, then resume numbering this one
+        text += "#line 1 " + std::to_string(source.files.size()) + "\n";
+        if (!append_file(include, depth + 1, source, text))
+        {
+            std::cout << "  (included from " << path << ":" << line_number << ")" << std::endl;
+            return false;
+        }
+        text += "#line " + std::to_string(line_number + 1) + " " + std::to_string(file_index) + "\n";
+    }
+    return true;
+}
+
+const ShaderSource *load_shader_source(const std::string &shader_path)
+{
+    auto found = shader_sources.find(shader_path);
+    if (found != shader_sources.end() && !source_changed(found->second))
+    {
+        return &found->second;
+    }
+
+    ShaderSource source;
+    if (!append_file(shader_path, 0, source, source.text))
+    {
+        return nullptr;
+    }
+    source.hash = hash_bytes(source.text.data(), source.text.size());
+    ShaderSource &cached = shader_sources[shader_path];
+    cached = std::move(source);
+    return &cached;
+}
+
+bool source_changed(const ShaderSource &source)
+{
+    for (size_t i = 0; i < source.files.size(); i++)
+    {
+        if (write_time_of(source.files[i]) != source.write_times[i]) return true;
+    }
+    return false;
+}
+
+ShaderSource with_defines(const ShaderSource &source, const std::string &defines)
+{
+    if (defines.empty())
+    {
+        return source;
+    }
+
+    // Definitions must follow #version, then line numbers of errors are reset to match the file
+    ShaderSource defined = source;
+    size_t version_end = source.text.find('\n') + 1;
+    defined.text = source.text.substr(0, version_end) + defines + "#line 2 0\n" + source.text.substr(version_end);
+    defined.hash = hash_bytes(defined.text.data(), defined.text.size());
+    return defined;
+}
+
+void print_source_files(const ShaderSource &source)
+{
+    for (size_t i = 0; i < source.files.size(); i++)
+    {
+        std::cout << "  source " << i << ": " << source.files[i] << std::endl;
+    }
+}
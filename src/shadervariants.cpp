@@ -0,0 +1,58 @@
+#include <iostream>
+#include "shadervariants.h"
+
+ShaderVariants::ShaderVariants(const std::string &vertex_shader_path, const std::string &fragment_shader_path,
+                               ProgramWarmup &warmup, bool &success) :
+    vertex_shader_path(vertex_shader_path), fragment_shader_path(fragment_shader_path), warmup(warmup)
+{
+    build(ALL_FEATURES, success);
+}
+
+std::string ShaderVariants::defines_of(uint features)
+{
+    std::string defines;
+    if (features & FEATURE_SUN) defines += "#define FEATURE_SUN\n";
+    if (features & FEATURE_FLASHLIGHT) defines += "#define FEATURE_FLASHLIGHT\n";
+    if (features & FEATURE_POINT_LIGHT) defines += "#define FEATURE_POINT_LIGHT\n";
+    if (features & FEATURE_SPECULAR_MAP) defines += "#define FEATURE_SPECULAR_MAP\n";
+    return defines;
+}
+
+Shaders *ShaderVariants::build(uint features, bool &success)
+{
+    std::unique_ptr<Shaders> &variant = variants[features];
+    variant = std::make_unique<Shaders>(vertex_shader_path, fragment_shader_path, success, defines_of(features));
+    if (!success)
+    {
+        std::cout << "Error: cannot build variant " << features << " of " << fragment_shader_path << std::endl;
+        return variant.get();
+    }
+    warmup.add(*variant);
+    return variant.get();
+}
+
+const Shaders &ShaderVariants::get(uint features)
+{
+    const Shaders *variant;
+    auto found = variants.find(features);
+    if (found != variants.end())
+    {
+        variant = found->second.get();
+    }
+    else
+    {
+        bool success;
+        variant = build(features, success);
+    }
+
+    if (variant->usable())
+    {
+        return *variant;
+    }
+    return *variants[ALL_FEATURES];
+}
+
+size_t ShaderVariants::size() const
+{
+    return variants.size();
+}
@@ -3,8 +3,10 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include "skybox.h"
+#include "glstate.h"
+#include "framestats.h"
 
-Skybox::Skybox(std::string textures_directory) : texture(textures_directory)
+Skybox::Skybox()
 {
     float vertices[] = {
         -1.0f,  1.0f, -1.0f,
@@ -56,9 +58,11 @@ Skybox::Skybox(std::string textures_directory) : texture(textures_directory)
     glGenVertexArrays(1, &array_obj);
  
     // Copy vertices to GPU
-    glBindVertexArray(array_obj);
+    state_bind_vertex_array(array_obj);
     glBindBuffer(GL_ARRAY_BUFFER, vbuf);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    gpu_bytes = sizeof(vertices);
+    track_gpu_memory(GPU_MEMORY_SKYBOX, gpu_bytes);
     
     // Set vertex attribute: position
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)0);
@@ -68,28 +72,26 @@ Skybox::Skybox(std::string textures_directory) : texture(textures_directory)
 Skybox::~Skybox()
 {
     std::cout << "NOTE: deleting skybox, VAO " << array_obj << std::endl;
+    track_gpu_memory(GPU_MEMORY_SKYBOX, -(int64_t)gpu_bytes);
+    state_forget_vertex_array(array_obj);
     glDeleteVertexArrays(1, &array_obj);
     glDeleteBuffers(1, &vbuf);
 }
 
-void Skybox::draw(const Shaders &program, const glm::mat4 &view_matrix, const glm::mat4 &proj_matrix) const
+void Skybox::draw(const Shaders &program, const CubeMap &texture) const
 {
     // Set depth function so that anything on the far plane (z == 1.0 in NDC) will be drawn
-    glDepthFunc(GL_LEQUAL);
+    state_depth_func(GL_LEQUAL);
     
     // Activate and bind cubemap texture
     program.use();
     texture.activate(0);
     program.uniform_int("cubemap", 0);
 
-    // Send transformations
-    glm::mat4 view_sans_translations = glm::mat4(glm::mat3(view_matrix)); // remove translation component
-    program.uniform_mat4("vp", proj_matrix * view_sans_translations);
-
     // Bind mesh and issue draw call
-    glBindVertexArray(array_obj);
+    state_bind_vertex_array(array_obj);
     glDrawArrays(GL_TRIANGLES, 0, 36);
 
     // Revert depth function to default
-    glDepthFunc(GL_LESS);
+    state_depth_func(GL_LESS);
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include "texturecache.h"
+#include "skyboxlibrary.h"
+
+namespace fs = std::filesystem;
+
+SkyboxLibrary::SkyboxLibrary(const std::string &skyboxes_directory) : 
+    shown(0), selected(0), decoding(false), background(1)
+{
+    for (const fs::directory_entry &entry : fs::directory_iterator(skyboxes_directory))
+    {
+        if (entry.is_directory())
+        {
+            directories.emplace_back(entry.path().string());
+        }
+    }
+    std::sort(directories.begin(), directories.end());
+    resident.resize(directories.size());
+
+    // Startup only pays for the first skybox, the next one is prefetched in the background
+    if (!directories.empty())
+    {
+        resident[0] = TextureCache::get_cubemap(directories[0]);
+        update();
+    }
+}
+
+uint SkyboxLibrary::size() const
+{
+    return directories.size();
+}
+
+uint SkyboxLibrary::next_of(uint index) const
+{
+    return (index + 1) % directories.size();
+}
+
+void SkyboxLibrary::select(uint index)
+{
+    selected = index;
+}
+
+void SkyboxLibrary::update()
+{
+    // Upload a skybox the background thread has finished decoding
+    std::unique_ptr<DecodedSkybox> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = std::move(decoded);
+    }
+    if (finished)
+    {
+        resident[finished->index] = TextureCache::insert_cubemap(finished->hash, finished->faces);
+        decoding = false;
+    }
+
+    // Switch once the selected skybox is resident, until then keep showing the previous one
+    if (resident[selected])
+    {
+        shown = selected;
+    }
+
+    // Evict everything that is neither on screen, nor selected, nor next in the cycle
+    for (uint i = 0; i < resident.size(); i++)
+    {
+        if (i != shown && i != selected && i != next_of(selected))
+        {
+            resident[i].reset();
+        }
+    }
+
+    // Decode what the user asked for first, then prefetch the next one
+    if (!decoding)
+    {
+        if (!resident[selected])
+        {
+            start_decoding(selected);
+        }
+        else if (!resident[next_of(selected)])
+        {
+            start_decoding(next_of(selected));
+        }
+    }
+}
+
+void SkyboxLibrary::start_decoding(uint index)
+{
+    decoding = true;
+    std::string directory = directories[index];
+    background.submit([this, index, directory] {
+        std::unique_ptr<DecodedSkybox> result = std::make_unique<DecodedSkybox>();
+        result->index = index;
+        TextureCache::read_cubemap(directory, result->hash, result->faces);
+        std::lock_guard<std::mutex> lock(mutex);
+        decoded = std::move(result);
+    });
+}
+
+const CubeMap &SkyboxLibrary::current() const
+{
+    return *resident[shown];
+}
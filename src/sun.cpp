@@ -9,14 +9,14 @@ Sun::Sun(glm::vec3 direction) : direction(direction)
     // Left empty intentionally
 }
 
-void Sun::use(const Shaders &program) const
+void Sun::use(LightData &data) const
 {
     float is_on = 0.f;
     if (is_sun) is_on = 1.f;
-    program.uniform_float("sun.diffuse_intensity", 0.9);
-    program.uniform_float("sun.specular_intensity", 0.5);
-    program.uniform_vec3("sun.direction", glm::vec4(direction, 0.f));
-    program.uniform_float("sun.is_on", is_on);
-    program.uniform_vec3("sun.color", SUN_COLOR);
-    program.uniform_float("sun.strength", SUN_STR);
+    data.diffuse_intensity = 0.9;
+    data.specular_intensity = 0.5;
+    data.direction = glm::vec4(direction, 0.f);
+    data.is_on = is_on;
+    data.color = glm::vec4(SUN_COLOR, 0.f);
+    data.strength = SUN_STR;
 }
\ No newline at end of file
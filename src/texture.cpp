@@ -1,64 +1,51 @@
 #include <iostream>
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
-#include "stb_image.h"
 #include "texture.h" 
+#include "glstate.h"
+#include "profiler.h"
+#include "framestats.h"
 
-Texture::Texture(const std::string &texture_path, TextureType type) : 
-    filepath(texture_path), type(type)
+Texture::Texture(const std::string &texture_path) : 
+    Texture(Image(texture_path))
 {
+    // Left empty intentionally
+}
+
+Texture::Texture(const Image &image) : 
+    gpu_bytes(0), filepath(image.filepath)
+{
+    PROFILE_ZONE("Texture::Texture");
+
     // Prepare OpenGL texture
     glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
+    state_bind_texture(0, GL_TEXTURE_2D, id);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-    // Read image file
-    int texwidth, texheight, texchannels;
-    stbi_set_flip_vertically_on_load(false);
-    unsigned char *texdata = stbi_load(texture_path.c_str(), &texwidth, &texheight, &texchannels, 0);
-
-    // Infere RGB or RGBA from number of channels
-    GLenum format = GL_RGB;
-    switch (texchannels)
-    {
-    case 3:
-        // Keep it GL_RGB
-        break;
-    case 4:
-        format = GL_RGBA;
-        break;
-    default:
-        std::cout << "Error: unsupported number of channels " << texchannels;
-        std::cout << " in texture " << texture_path << std::endl;
-        break;
-    }
-
     // Copy image into GPU
-    if (texdata)
+    if (image.is_valid())
     {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, texwidth, texheight, 0, format, GL_UNSIGNED_BYTE, texdata);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width, image.height, 0, image.gl_format(), GL_UNSIGNED_BYTE, image.pixels);
         glGenerateMipmap(GL_TEXTURE_2D);
+
+        // Drivers pad RGB texels to 4 bytes, and a full mipmap chain adds another third
+        gpu_bytes = (size_t)image.width * image.height * 4 * 4 / 3;
+        track_gpu_memory(GPU_MEMORY_TEXTURES, gpu_bytes);
     }
-    else
-    {
-        std::cout << "Failed to load texture" << std::endl;
-        std::cout << texture_path << std::endl;
-    }
-    
-    stbi_image_free(texdata);
 }
 
 Texture::~Texture()
 {
     std::cout << "NOTE: deleteing texture " << id << std::endl;
+    track_gpu_memory(GPU_MEMORY_TEXTURES, -(int64_t)gpu_bytes);
+    state_forget_texture(id);
     glDeleteTextures(1, &id);
 }
 
 void Texture::activate(uint unit) const
 {
-    glActiveTexture(GL_TEXTURE0 + unit);
-    glBindTexture(GL_TEXTURE_2D, id);
-}
\ No newline at end of file
+    state_bind_texture(unit, GL_TEXTURE_2D, id);
+}
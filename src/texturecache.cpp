@@ -0,0 +1,159 @@
+#include <iostream>
+#include "hash.h"
+#include "mappedfile.h"
+#include "texturecache.h"
+
+uint TextureCache::hits = 0;
+uint TextureCache::misses = 0;
+std::unordered_map<uint64_t, std::weak_ptr<Texture>> TextureCache::textures;
+std::unordered_map<uint64_t, std::weak_ptr<CubeMap>> TextureCache::cubemaps;
+std::unordered_map<std::string, uint64_t> TextureCache::path_hashes;
+
+std::shared_ptr<Texture> TextureCache::get(const std::string &texture_path)
+{
+    // Fast path: the same file was requested before and is still resident
+    auto known = path_hashes.find(texture_path);
+    if (known != path_hashes.end())
+    {
+        std::shared_ptr<Texture> texture = textures[known->second].lock();
+        if (texture)
+        {
+            hits++;
+            return texture;
+        }
+    }
+
+    // Address by content
+    MappedFile file(texture_path);
+    if (!file.is_open())
+    {
+        // Let the texture report the error, nothing worth caching
+        misses++;
+        return std::make_shared<Texture>(texture_path);
+    }
+    uint64_t hash = hash_bytes(file.data, file.size);
+    path_hashes[texture_path] = hash;
+    std::weak_ptr<Texture> &entry = textures[hash];
+    std::shared_ptr<Texture> texture = entry.lock();
+    if (texture)
+    {
+        hits++;
+        return texture;
+    }
+
+    // Decode straight from the mapping, the file is not read twice
+    misses++;
+    texture = std::make_shared<Texture>(Image(file.data, file.size, texture_path));
+    entry = texture;
+    return texture;
+}
+
+std::shared_ptr<Texture> TextureCache::insert(const std::string &texture_path, uint64_t content_hash, const Image &image)
+{
+    path_hashes[texture_path] = content_hash;
+    std::weak_ptr<Texture> &entry = textures[content_hash];
+    std::shared_ptr<Texture> texture = entry.lock();
+    if (texture)
+    {
+        hits++;
+        return texture;
+    }
+    misses++;
+    texture = std::make_shared<Texture>(image);
+    entry = texture;
+    return texture;
+}
+
+std::shared_ptr<CubeMap> TextureCache::get_cubemap(const std::string &texture_directory)
+{
+    // A cubemap is addressed by the contents of all of its faces
+    std::vector<std::unique_ptr<MappedFile>> files;
+    uint64_t hash = map_cubemap(texture_directory, files);
+    std::shared_ptr<CubeMap> cubemap = cubemaps[hash].lock();
+    if (cubemap)
+    {
+        hits++;
+        return cubemap;
+    }
+
+    // Decode faces from the mappings and upload
+    std::vector<std::unique_ptr<Image>> faces;
+    decode_cubemap(texture_directory, files, faces);
+    return insert_cubemap(hash, faces);
+}
+
+void TextureCache::read_cubemap(const std::string &texture_directory, uint64_t &content_hash, std::vector<std::unique_ptr<Image>> &faces)
+{
+    std::vector<std::unique_ptr<MappedFile>> files;
+    content_hash = map_cubemap(texture_directory, files);
+    decode_cubemap(texture_directory, files, faces);
+}
+
+std::shared_ptr<CubeMap> TextureCache::insert_cubemap(uint64_t content_hash, const std::vector<std::unique_ptr<Image>> &faces)
+{
+    std::weak_ptr<CubeMap> &entry = cubemaps[content_hash];
+    std::shared_ptr<CubeMap> cubemap = entry.lock();
+    if (cubemap)
+    {
+        hits++;
+        return cubemap;
+    }
+    misses++;
+    cubemap = std::make_shared<CubeMap>(faces);
+    entry = cubemap;
+    return cubemap;
+}
+
+uint64_t TextureCache::map_cubemap(const std::string &texture_directory, std::vector<std::unique_ptr<MappedFile>> &files)
+{
+    uint64_t hash = HASH_SEED;
+    for (const std::string &path : CubeMap::face_paths(texture_directory))
+    {
+        files.emplace_back(std::make_unique<MappedFile>(path));
+        if (files.back()->is_open())
+        {
+            hash = hash_bytes(files.back()->data, files.back()->size, hash);
+        }
+    }
+    return hash;
+}
+
+void TextureCache::decode_cubemap(const std::string &texture_directory, const std::vector<std::unique_ptr<MappedFile>> &files, 
+                                  std::vector<std::unique_ptr<Image>> &faces)
+{
+    std::vector<std::string> paths = CubeMap::face_paths(texture_directory);
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        if (files[i]->is_open())
+        {
+            faces.emplace_back(std::make_unique<Image>(files[i]->data, files[i]->size, paths[i]));
+        }
+        else
+        {
+            // Let the image report the error
+            faces.emplace_back(std::make_unique<Image>(paths[i]));
+        }
+    }
+}
+
+size_t TextureCache::resident_bytes()
+{
+    size_t bytes = 0;
+    for (const auto &[hash, entry] : textures)
+    {
+        std::shared_ptr<Texture> texture = entry.lock();
+        if (texture) bytes += texture->gpu_bytes;
+    }
+    for (const auto &[hash, entry] : cubemaps)
+    {
+        std::shared_ptr<CubeMap> cubemap = entry.lock();
+        if (cubemap) bytes += cubemap->gpu_bytes;
+    }
+    return bytes;
+}
+
+void TextureCache::print_stats()
+{
+    std::cout << "Texture cache: " << hits << " hits, " << misses << " misses, ";
+    std::cout << resident_bytes() / (1024 * 1024) << "MB resident" << std::endl;
+}
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include "threadpool.h"
+#include "profiler.h"
+
+ThreadPool::ThreadPool(uint num_threads) : num_running(0), stopping(false)
+{
+    if (num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (uint i = 0; i < num_threads; i++)
+    {
+        workers.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_available.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(task));
+    }
+    task_available.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    all_done.wait(lock, [this] { return tasks.empty() && num_running == 0; });
+}
+
+uint ThreadPool::size() const
+{
+    return workers.size();
+}
+
+void ThreadPool::worker_loop()
+{
+    profiler_set_thread_name("worker");
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        task_available.wait(lock, [this] { return stopping || !tasks.empty(); });
+        if (tasks.empty())
+        {
+            // Stopping, and nothing left to do
+            return;
+        }
+
+        // Run the next task without holding the lock
+        std::function<void()> task = std::move(tasks.front());
+        tasks.pop();
+        num_running++;
+        lock.unlock();
+        task();
+        lock.lock();
+        num_running--;
+        if (tasks.empty() && num_running == 0)
+        {
+            all_done.notify_all();
+        }
+    }
+}
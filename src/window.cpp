@@ -3,11 +3,25 @@
 #include <GLFW/glfw3.h>
 #include "window.h"
 #include "callbacks.h"
+#include "glstate.h"
+#include "profiler.h"
+#include "glcounters.h"
 
-Window::Window(uint width, uint height, bool &success)
+Window::Window(uint width, uint height, bool headless, bool &success)
 {
-    // Initialize the library 
+    // Initialize the library, without a display server when headless
     glfwSetErrorCallback(error_callback);
+#if GLFW_VERSION_MAJOR > 3 || GLFW_VERSION_MINOR >= 4
+    if (headless)
+    {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
+#else
+    if (headless)
+    {
+        std::cout << "NOTE: GLFW older than 3.4 has no null platform, headless mode still needs a display" << std::endl;
+    }
+#endif
     if (!glfwInit())
     {
         std::cout << "Failed to initialize GLFW" << std::endl;
@@ -20,6 +34,12 @@ Window::Window(uint width, uint height, bool &success)
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (headless)
+    {
+        // Software rendering (e.g. Mesa llvmpipe) into an off-screen buffer, no GPU needed
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    }
     handle = glfwCreateWindow(width, height, "playgroundgl", nullptr, nullptr);
     if (!handle)
     {
@@ -36,12 +56,19 @@ Window::Window(uint width, uint height, bool &success)
         success = false;
         return;
     }
+    install_gl_counters();
     glViewport(0, 0, width, height);
-    glfwSwapInterval(1);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_STENCIL_TEST);
-    glStencilMask(0x00); // Do not write to stencil buffer unless explicitly wanted
-    glEnable(GL_CULL_FACE);
+    glfwSwapInterval(headless ? 0 : 1);
+    state_set_capability(GL_DEPTH_TEST, true);
+    state_set_capability(GL_STENCIL_TEST, true);
+    state_stencil_mask(0x00); // Do not write to stencil buffer unless explicitly wanted
+    state_set_capability(GL_CULL_FACE, true);
+    std::cout << "OpenGL renderer: " << glGetString(GL_RENDERER) << std::endl;
+    if (headless)
+    {
+        success = true;
+        return;
+    }
     
     // Set callbacks
     glfwSetKeyCallback(handle, key_callback);
@@ -71,10 +98,16 @@ Window::~Window()
 bool Window::next_frame_ready() const
 {
     // Swap front and back buffers
-    glfwSwapBuffers(handle);
+    {
+        PROFILE_ZONE("swap buffers");
+        glfwSwapBuffers(handle);
+    }
 
     // Poll for and process events
-    glfwPollEvents();
+    {
+        PROFILE_ZONE("poll events");
+        glfwPollEvents();
+    }
 
     if (glfwWindowShouldClose(handle))
     {